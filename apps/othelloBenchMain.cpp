@@ -0,0 +1,181 @@
+#include <othello/Player.h>
+#include <othello/RandomMoves.h>
+
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+using namespace othello;
+
+namespace {
+
+using Position = std::pair<Board, Board::Color>;
+using Positions = std::vector<Position>;
+
+// play random games (using a fixed seed so runs are comparable) and collect
+// every position that has at least one valid move
+Positions randomPositions(size_t games) {
+  std::mt19937 gen(1);
+  Positions result;
+  for (size_t i = 0; i < games; ++i) {
+    Board board;
+    auto c = Board::Color::Black;
+    do {
+      if (!board.hasValidMoves(c)) c = Board::opColor(c);
+      if (board.hasValidMoves(c)) result.emplace_back(board, c);
+    } while (randomMove(board, c, gen));
+  }
+  return result;
+}
+
+template<typename T> auto seconds(T start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+    .count();
+}
+
+auto& printRate(const char* name, size_t count, double elapsed) {
+  return std::cout << "  " << std::setw(8) << name << ": " << std::fixed
+                   << std::setprecision(1)
+                   << static_cast<double>(count) / elapsed / 1'000'000.0
+                   << "M moves/sec";
+}
+
+// make every valid move from every position 'repeat' times and print moves per
+// second for each flip kernel supported by the CPU
+void benchFlips(const Positions& positions, size_t repeat) {
+  std::cout << "flips (" << positions.size() << " positions x " << repeat
+            << "):\n";
+  for (auto kernel : Board::FlipKernels) {
+    if (!Board::setFlipKernel(kernel)) {
+      std::cout << "  " << std::setw(8) << kernel << ": not supported\n";
+      continue;
+    }
+    size_t moves = 0, flips = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeat; ++i)
+      for (auto& [board, c] : positions)
+        for (auto pos : board.validMoveBits(c)) {
+          auto b = board;
+          flips += static_cast<size_t>(b.set(pos, c));
+          ++moves;
+        }
+    // print total flips as well to show that all kernels get the same results
+    printRate(toString(kernel), moves, seconds(start))
+      << " (" << flips << " flips)\n";
+  }
+}
+
+// make and unmake every valid move from every position 'repeat' times (using
+// the current flip kernel), i.e., the way moves are played during a search
+void benchMakeMove(const Positions& positions, size_t repeat) {
+  std::cout << "make/unmake (" << Board::flipKernel() << "):\n";
+  size_t moves = 0;
+  Board::Set hashes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeat; ++i)
+    for (auto [board, c] : positions)
+      for (auto pos : board.validMoveBits(c)) {
+        const auto undo = board.makeMove(pos, c);
+        hashes += board.hash(Board::opColor(c));
+        board.unmakeMove(undo);
+        ++moves;
+      }
+  printRate("moves", moves, seconds(start)) << " (hashes: " << std::hex
+                                            << hashes << std::dec << ")\n";
+}
+
+// search every 'step' position to a fixed depth with and without move ordering
+// (and with all hardware threads) and print the total number of nodes
+// (positions searched plus leaf positions scored) to show how much ordering
+// helps alpha-beta pruning
+void benchSearch(const Positions& positions, size_t depth, size_t step) {
+  std::cout << "search (depth " << depth << ", "
+            << (positions.size() + step - 1) / step << " positions):\n";
+  const auto score = std::make_shared<FullScore>();
+  const size_t threads = std::max(std::thread::hardware_concurrency(), 1U);
+  struct Config {
+    std::string name;
+    bool ordering;
+    size_t threads;
+  };
+  std::vector<Config> configs = {{"scan", false, 1}, {"ordered", true, 1}};
+  if (threads > 1)
+    configs.push_back({"threads=" + std::to_string(threads), true, threads});
+  for (auto& config : configs) {
+    const std::array<ComputerPlayer, 2> players = {
+      ComputerPlayer(Board::Color::Black, depth, false, score,
+                     {.moveOrdering = config.ordering,
+                      .threads = config.threads}),
+      ComputerPlayer(Board::Color::White, depth, false, score,
+                     {.moveOrdering = config.ordering,
+                      .threads = config.threads})};
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < positions.size(); i += step) {
+      auto [board, c] = positions[i];
+      players[static_cast<size_t>(c)].move(board, true, {});
+    }
+    const auto elapsed = seconds(start);
+    long long nodes = 0, scoreCalls = 0;
+    for (auto& i : players) {
+      nodes += i.totalNodes();
+      scoreCalls += i.totalScoreCalls();
+    }
+    std::cout << "  " << std::setw(10) << config.name << ": "
+              << nodes + scoreCalls << " nodes (" << nodes << " searched, "
+              << scoreCalls << " scored), " << std::fixed
+              << std::setprecision(3) << elapsed << " secs\n";
+  }
+}
+
+// search every 'step' position to a fixed depth with 1, 2, 4, etc. threads (up
+// to the number of hardware threads) using each type of parallel search and
+// print the time to reach the depth and the speedup compared to 1 thread
+void benchParallel(const Positions& positions, size_t depth, size_t step) {
+  using Parallel = ComputerPlayer::Parallel;
+  std::cout << "time to depth " << depth << " ("
+            << (positions.size() + step - 1) / step << " positions):\n";
+  const auto score = std::make_shared<FullScore>();
+  const auto run = [&](size_t threads, Parallel parallel) {
+    const std::array<ComputerPlayer, 2> players = {
+      ComputerPlayer(Board::Color::Black, depth, false, score,
+                     {.threads = threads, .parallel = parallel}),
+      ComputerPlayer(Board::Color::White, depth, false, score,
+                     {.threads = threads, .parallel = parallel})};
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < positions.size(); i += step) {
+      auto [board, c] = positions[i];
+      players[static_cast<size_t>(c)].move(board, true, {});
+    }
+    return seconds(start);
+  };
+  const auto base = run(1, Parallel::RootSplit);
+  std::cout << "  " << std::setw(24) << "threads=1" << ": " << std::fixed
+            << std::setprecision(3) << base << " secs\n";
+  const size_t hardware = std::max(std::thread::hardware_concurrency(), 2U);
+  for (size_t threads = 2; threads <= hardware; threads *= 2)
+    for (auto parallel :
+         {Parallel::RootSplit, Parallel::LazySmp, Parallel::Ybwc}) {
+      const auto elapsed = run(threads, parallel);
+      std::cout << "  " << std::setw(24)
+                << "threads=" + std::to_string(threads) +
+                     (parallel == Parallel::LazySmp ? " (lazy smp)"
+                      : parallel == Parallel::Ybwc  ? " (ybwc)"
+                                                    : " (root split)")
+                << ": " << std::setprecision(3) << elapsed << " secs, "
+                << std::setprecision(2) << base / elapsed << "x speedup\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t repeat = argc > 1 ? std::stoul(argv[1]) : 20;
+  const auto kernel = Board::flipKernel();
+  const auto positions = randomPositions(1000);
+  benchFlips(positions, repeat);
+  Board::setFlipKernel(kernel);
+  benchMakeMove(positions, repeat);
+  benchSearch(positions, 6, 500);
+  benchParallel(positions, 7, 500);
+  return 0;
+}
@@ -0,0 +1,108 @@
+#include <othello/OpeningBook.h>
+#include <othello/Player.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+using namespace othello;
+
+namespace {
+
+using Position = std::pair<Board, Board::Color>;
+using Positions = std::vector<Position>;
+
+// collect the canonical form of every position (with at least one valid move)
+// that can be reached from the initial board in up to 'plies' moves. Passes
+// don't use up a ply and equivalent positions are only added once.
+Positions bookPositions(size_t plies) {
+  Positions result;
+  std::unordered_set<Board::Set> seen;
+  const auto add = [&](const auto& self, const Board& board, Board::Color c,
+                       size_t ply) -> void {
+    if (!board.hasValidMoves(c)) {
+      c = Board::opColor(c);
+      if (!board.hasValidMoves(c)) return;
+    }
+    const auto canonical = board.canonical().first;
+    if (!seen.insert(canonical.hash(c)).second) return;
+    result.emplace_back(canonical, c);
+    if (ply < plies)
+      for (const auto& [pos, child] : canonical.children(c))
+        self(self, child, Board::opColor(c), ply + 1);
+  };
+  add(add, Board(), Board::Color::Black, 0);
+  return result;
+}
+
+int usage(const char* name) {
+  std::cerr << "usage: " << name << " [file] [plies] [depth] [threads]\n"
+            << "  file: book file to write (default othello.book)\n"
+            << "  plies: moves from the initial board to include (default 6)\n"
+            << "  depth: search depth for each position (default 8)\n"
+            << "  threads: positions searched at the same time (default is "
+               "the number of hardware threads)\n";
+  return 2;
+}
+
+} // namespace
+
+// build an opening book by searching every position up to 'plies' moves from
+// the initial board (using 'FullScore') and write it to 'file'
+int main(int argc, char** argv) {
+  std::string file = "othello.book";
+  size_t plies = 6, depth = 8,
+         threads = std::max(std::thread::hardware_concurrency(), 1U);
+  try {
+    if (argc > 1) file = argv[1];
+    if (argc > 2) plies = std::stoul(argv[2]);
+    if (argc > 3) depth = std::stoul(argv[3]);
+    if (argc > 4) threads = std::stoul(argv[4]);
+  } catch (const std::exception&) {
+    return usage(argv[0]);
+  }
+  if (argc > 5 || !depth || !threads) return usage(argv[0]);
+  const auto start = std::chrono::steady_clock::now();
+  const auto positions = bookPositions(plies);
+  std::cout << positions.size() << " positions up to " << plies
+            << " plies, search depth " << depth << ", threads " << threads
+            << '\n';
+  // each thread takes the next unsearched position (and has its own players
+  // so nothing is shared while searching)
+  std::vector<OpeningBook::Entry> entries(positions.size());
+  std::atomic<size_t> next = 0, done = 0;
+  std::mutex printMutex;
+  const auto score = std::make_shared<FullScore>();
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::min(threads, positions.size()); ++i)
+    workers.emplace_back([&] {
+      const std::array<ComputerPlayer, 2> players = {
+        ComputerPlayer(Board::Color::Black, depth, false, score),
+        ComputerPlayer(Board::Color::White, depth, false, score)};
+      for (auto j = next++; j < positions.size(); j = next++) {
+        const auto& [board, c] = positions[j];
+        const auto [move, value] =
+          players[static_cast<size_t>(c)].analyze(board);
+        entries[j] = {board.hash(c), value, static_cast<uint8_t>(move),
+                      static_cast<uint8_t>(depth)};
+        if (const auto count = ++done; count % 1000 == 0) {
+          const std::lock_guard lock(printMutex);
+          std::cout << "  searched " << count << " positions\n";
+        }
+      }
+    });
+  for (auto& i : workers) i.join();
+  if (!OpeningBook::write(file, std::move(entries))) {
+    std::cerr << "failed to write " << file << '\n';
+    return 1;
+  }
+  std::cout << "wrote " << file << " in " << std::fixed << std::setprecision(3)
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+                 .count()
+            << " secs\n";
+  return 0;
+}
@@ -1,6 +1,9 @@
 #include <othello/Game.h>
 
-int main() {
-  othello::Game().begin();
+#include <string>
+
+// pass '-s' to print search stats for computer players at the end
+int main(int argc, char** argv) {
+  othello::Game(argc > 1 && std::string(argv[1]) == "-s").begin();
   return 0;
 }
@@ -0,0 +1,125 @@
+#include <othello/Board.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+using namespace othello;
+
+namespace {
+
+// known leaf counts (from the initial position with Black to move) for depths
+// 1 to 10 where a pass counts as a ply and a finished game is a leaf
+constexpr std::array<size_t, 10> KnownCounts = {
+  4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288, 24571284};
+
+// count leaf nodes to 'depth' plies. Turns are skipped the same way as in
+// 'Game::playOneGame', i.e., if 'c' has no valid moves then the other color
+// plays (the pass uses up a ply) and if neither color can move the game is
+// over (and the position is a leaf).
+size_t perft(Board& board, Board::Color c, size_t depth) {
+  const auto moves = board.validMoveBits(c);
+  if (moves.empty()) {
+    if (!board.hasValidMoves(Board::opColor(c))) return 1;
+    return depth > 1 ? perft(board, Board::opColor(c), depth - 1) : 1;
+  }
+  if (depth == 1) return moves.count(); // no need to make the last moves
+  size_t nodes = 0;
+  for (auto pos : moves) {
+    const auto undo = board.makeMove(pos, c);
+    nodes += perft(board, Board::opColor(c), depth - 1);
+    board.unmakeMove(undo);
+  }
+  return nodes;
+}
+
+// split the root moves across 'threads' threads (each thread takes the next
+// unclaimed root move until there are none left)
+size_t perft(const Board& board, Board::Color c, size_t depth,
+             size_t threads) {
+  const auto moves = board.validMoveBits(c);
+  if (threads < 2 || depth < 2 || moves.count() < 2) {
+    auto b = board;
+    return perft(b, c, depth);
+  }
+  const std::vector<size_t> positions(moves.begin(), moves.end());
+  std::atomic<size_t> next = 0, nodes = 0;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::min(threads, positions.size()); ++i)
+    workers.emplace_back([&] {
+      for (auto j = next++; j < positions.size(); j = next++) {
+        auto b = board;
+        b.makeMove(positions[j], c);
+        nodes += perft(b, Board::opColor(c), depth - 1);
+      }
+    });
+  for (auto& i : workers) i.join();
+  return nodes;
+}
+
+int usage(const char* name) {
+  std::cerr << "usage: " << name << " [depth] [threads] [board] [b|w]\n"
+            << "  depth: plies to search (default 9)\n"
+            << "  threads: split root moves across threads (default 1)\n"
+            << "  board: 64 cells using '" << Board::BlackCell << "', '"
+            << Board::WhiteCell << "' and '" << Board::EmptyCell
+            << "' (default is the initial board)\n"
+            << "  b|w: color to move (default b)\n";
+  return 2;
+}
+
+} // namespace
+
+// print leaf counts and nodes per second for each depth from 1 to 'depth'. The
+// counts are checked for the initial board (returns 1 if there's a mismatch)
+// so this can be used as a regression test for Board changes.
+int main(int argc, char** argv) {
+  size_t depth = 9, threads = 1;
+  Board board;
+  auto c = Board::Color::Black;
+  try {
+    if (argc > 1) depth = std::stoul(argv[1]);
+    if (argc > 2) threads = std::stoul(argv[2]);
+  } catch (const std::exception&) {
+    return usage(argv[0]);
+  }
+  if (argc > 3) {
+    const std::string layout(argv[3]);
+    if (layout.size() > Board::Size) return usage(argv[0]);
+    board = Board(layout);
+  }
+  if (argc > 4) {
+    const std::string color(argv[4]);
+    if (color != "b" && color != "w") return usage(argv[0]);
+    if (color == "w") c = Board::Color::White;
+  }
+  if (argc > 5 || !depth || !threads) return usage(argv[0]);
+  const auto check = board == Board() && c == Board::Color::Black;
+  std::cout << board << c << " to move, flip kernel: " << Board::flipKernel()
+            << ", threads: " << threads << '\n';
+  auto failed = false;
+  for (size_t d = 1; d <= depth; ++d) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto nodes = perft(board, c, d, threads);
+    const auto elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+        .count();
+    std::cout << "depth " << std::setw(2) << d << ": " << std::setw(13)
+              << nodes << " nodes, " << std::fixed << std::setprecision(3)
+              << elapsed << " secs, " << std::setprecision(1)
+              << (elapsed > 0 ? static_cast<double>(nodes) / elapsed : 0.0) /
+                   1'000'000.0
+              << "M nodes/sec";
+    if (check && d <= KnownCounts.size()) {
+      if (nodes == KnownCounts[d - 1])
+        std::cout << " (ok)";
+      else {
+        std::cout << " (error: expected " << KnownCounts[d - 1] << ')';
+        failed = true;
+      }
+    }
+    std::cout << '\n';
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+#include <othello/Player.h>
+#include <othello/ProbCut.h>
+#include <othello/RandomMoves.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+using namespace othello;
+
+namespace {
+
+using Position = std::pair<Board, Board::Color>;
+using Positions = std::vector<Position>;
+
+// positions are taken from plies 'MinPly' to 'MaxPly' and a check is only
+// fitted if there are at least 'MinSamples' positions for its stage
+constexpr size_t MinPly = 2, MaxPly = 56, MinSamples = 30, TableMegabytes = 4;
+
+// play random games (using a fixed seed so runs are comparable) and take one
+// position (with at least one valid move) from each game at a random ply
+Positions randomPositions(size_t count) {
+  std::mt19937 gen(1);
+  Positions result;
+  while (result.size() < count) {
+    const auto ply = MinPly + gen() % (MaxPly - MinPly + 1);
+    Board board;
+    auto c = Board::Color::Black;
+    for (size_t i = 0; i < ply && randomMove(board, c, gen); ++i) {}
+    if (!board.hasValidMoves(c)) c = Board::opColor(c);
+    if (board.hasValidMoves(c)) result.emplace_back(board, c);
+  }
+  return result;
+}
+
+// 'Scores' has the search score of a position for each depth (index 0 is
+// depth 1) or is empty if any score was a final result (win, loss or draw)
+using Scores = std::vector<int>;
+
+// search every position to each depth up to 'ProbCut::MaxDepth' using 'score'
+// (with 'threads' positions searched at the same time)
+std::vector<Scores> searchPositions(const Positions& positions,
+                                    const std::shared_ptr<Score>& score,
+                                    size_t threads) {
+  std::vector<Scores> result(positions.size());
+  std::atomic<size_t> next = 0, done = 0;
+  std::mutex printMutex;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::min(threads, positions.size()); ++i)
+    workers.emplace_back([&] {
+      // a player for each color and depth
+      std::vector<std::unique_ptr<ComputerPlayer>> players;
+      for (size_t depth = 1; depth <= ProbCut::MaxDepth; ++depth)
+        for (auto c : {Board::Color::Black, Board::Color::White})
+          players.emplace_back(std::make_unique<ComputerPlayer>(
+            c, depth, false, score,
+            ComputerPlayer::Options{.tableMegabytes = TableMegabytes}));
+      for (auto j = next++; j < positions.size(); j = next++) {
+        const auto& [board, c] = positions[j];
+        Scores scores;
+        for (size_t depth = 1; depth <= ProbCut::MaxDepth; ++depth) {
+          const auto value =
+            players[(depth - 1) * 2 + static_cast<size_t>(c)]
+              ->analyze(board)
+              .second;
+          if (std::abs(value) >= Score::Win) {
+            scores.clear();
+            break;
+          }
+          scores.push_back(value);
+        }
+        result[j] = std::move(scores);
+        if (const auto count = ++done; count % 100 == 0) {
+          const std::lock_guard lock(printMutex);
+          std::cerr << "  searched " << count << " positions\n";
+        }
+      }
+    });
+  for (auto& i : workers) i.join();
+  return result;
+}
+
+// fit the checks for 'score' and print them in the format used by
+// 'Calibrations' in ProbCut.cpp
+void calibrate(const Positions& positions, const std::shared_ptr<Score>& score,
+               size_t threads) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto scores = searchPositions(positions, score, threads);
+  std::vector<ProbCut::Check> checks;
+  std::array<size_t, ProbCut::Stages> samples{};
+  for (size_t stage = 0; stage < ProbCut::Stages; ++stage)
+    for (size_t depth = ProbCut::MinDepth; depth <= ProbCut::MaxDepth;
+         ++depth) {
+      const auto shallow = ProbCut::shallowDepth(depth);
+      std::vector<std::pair<int, int>> pairs;
+      for (size_t i = 0; i < positions.size(); ++i)
+        if (!scores[i].empty() &&
+            ProbCut::stage(positions[i].first) == stage)
+          pairs.emplace_back(scores[i][shallow - 1], scores[i][depth - 1]);
+      samples[stage] = pairs.size();
+      if (pairs.size() >= MinSamples)
+        checks.push_back(ProbCut::fit(stage, depth, shallow, pairs));
+    }
+  std::cerr << score->toString() << " took " << std::fixed
+            << std::setprecision(1)
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+                 .count()
+            << " secs\n";
+  const auto flags = std::cout.flags();
+  std::cout << "  // " << score->toString() << ": " << positions.size()
+            << " positions, samples by stage:";
+  for (auto i : samples) std::cout << ' ' << i;
+  std::cout << "\n  {\"" << score->toString() << "\",\n   {" << std::fixed;
+  for (size_t i = 0; i < checks.size(); ++i) {
+    const auto& c = checks[i];
+    if (i) std::cout << ",\n    ";
+    std::cout << '{' << c.stage << ", " << c.depth << ", " << c.shallow << ", "
+              << std::setprecision(3) << c.a << ", " << std::setprecision(1)
+              << c.b << ", " << c.sigma << '}';
+  }
+  std::cout << "}},\n";
+  std::cout.flags(flags);
+}
+
+int usage(const char* name) {
+  std::cerr << "usage: " << name << " [positions] [score] [threads]\n"
+            << "  positions: number of random positions (default 800)\n"
+            << "  score: f=full heuristic, w=weighted cells, a=all (default)\n"
+            << "  threads: positions searched at the same time (default is "
+               "the number of hardware threads)\n";
+  return 2;
+}
+
+} // namespace
+
+// fit the Multi-ProbCut parameters for each 'Score' type by searching random
+// positions to every depth and comparing shallow and deep search scores
+int main(int argc, char** argv) {
+  size_t count = 800,
+         threads = std::max(std::thread::hardware_concurrency(), 1U);
+  char type = 'a';
+  try {
+    if (argc > 1) count = std::stoul(argv[1]);
+    if (argc > 2) type = argv[2][0];
+    if (argc > 3) threads = std::stoul(argv[3]);
+  } catch (const std::exception&) {
+    return usage(argv[0]);
+  }
+  if (argc > 4 || !count || !threads ||
+      type != 'a' && type != 'f' && type != 'w')
+    return usage(argv[0]);
+  const auto positions = randomPositions(count);
+  if (type != 'w')
+    calibrate(positions, std::make_shared<FullScore>(), threads);
+  if (type != 'f')
+    calibrate(positions, std::make_shared<WeightedScore>(), threads);
+  return 0;
+}
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <bitset>
+#include <bit>
 #include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace othello {
@@ -29,18 +35,139 @@ public:
     SizeSub1 = 63,
     Size
   };
-  using Moves = std::vector<std::string>;
-  using Boards = std::array<Board, MaxValidMoves>;
-  using Positions = std::array<size_t, MaxValidMoves>;
-  using Set = std::bitset<Size>;
+
+  // 'Move' is a compact move: the position of the cell that was played (0 to
+  // 63) or 'Pass' (the default value). Strings like 'e6' are only used when
+  // talking to people or to remote players (see 'toString' and 'toPos').
+  class Move {
+  public:
+    static constexpr uint8_t Pass = Size;
+    constexpr Move() noexcept = default;
+    constexpr explicit Move(size_t pos) noexcept
+        : _pos(static_cast<uint8_t>(pos)) {
+      assert(pos <= Pass);
+    }
+    constexpr size_t pos() const noexcept { return _pos; }
+    constexpr bool pass() const noexcept { return _pos == Pass; }
+    constexpr explicit operator size_t() const noexcept { return _pos; }
+    constexpr auto operator<=>(const Move&) const noexcept = default;
+    std::string toString() const {
+      return pass() ? "pass" : posToString(_pos);
+    }
+  private:
+    uint8_t _pos = Pass;
+  };
+
+  // 'Moves' is a fixed capacity list of moves stored inline (no allocation).
+  // Capacity is 'Size' which is more than the valid moves of any position and
+  // more than the moves in a game.
+  class Moves {
+  public:
+    using value_type = Move;
+    using iterator = Move*;
+    using const_iterator = const Move*;
+    constexpr Moves() noexcept = default;
+    constexpr Moves(std::initializer_list<Move> moves) noexcept {
+      assign(moves.begin(), moves.end());
+    }
+    constexpr auto begin() noexcept { return _moves.data(); }
+    constexpr auto end() noexcept { return _moves.data() + _size; }
+    constexpr auto begin() const noexcept { return _moves.data(); }
+    constexpr auto end() const noexcept { return _moves.data() + _size; }
+    constexpr auto size() const noexcept { return _size; }
+    constexpr auto empty() const noexcept { return _size == 0; }
+    constexpr auto& operator[](size_t i) noexcept { return _moves[i]; }
+    constexpr auto operator[](size_t i) const noexcept { return _moves[i]; }
+    constexpr auto front() const noexcept { return _moves[0]; }
+    constexpr void clear() noexcept { _size = 0; }
+    constexpr void push_back(Move m) noexcept {
+      assert(_size < Size);
+      _moves[_size++] = m;
+    }
+    constexpr void emplace_back(size_t pos) noexcept { push_back(Move(pos)); }
+    // 'assign' replaces the list with a range of 'Move' values or positions
+    template<typename I> constexpr void assign(I first, I last) noexcept {
+      for (clear(); first != last; ++first)
+        push_back(Move(static_cast<size_t>(*first)));
+    }
+    constexpr bool operator==(const Moves& rhs) const noexcept {
+      return std::equal(begin(), end(), rhs.begin(), rhs.end());
+    }
+  private:
+    std::array<Move, Size> _moves{};
+    size_t _size = 0;
+  };
+
+  // cells for each color are stored in a 64-bit word where bit 'n' is set if
+  // position 'n' has that color (a1 is bit 0, h1 is bit 7 and h8 is bit 63)
+  using Set = uint64_t;
   static constexpr char BlackCell = '*';
   static constexpr char WhiteCell = 'o';
   static constexpr char EmptyCell = '.';
 
+  // constexpr helpers for working with 'Set' values
+  static constexpr Set bit(size_t pos) noexcept { return 1ULL << pos; }
+  static constexpr size_t count(Set s) noexcept {
+    return static_cast<size_t>(std::popcount(s));
+  }
+  static constexpr bool test(Set s, std::integral auto i) noexcept {
+    return s >> i & 1;
+  }
+  template<typename... Ts>
+  static constexpr bool test(Set s, std::integral auto i, Ts... args) noexcept {
+    return test(s, i) || test(s, args...);
+  }
+  // shift all cells by 'N' positions (negative values shift towards 'a1')
+  template<int N> static constexpr Set shift(Set s) noexcept {
+    if constexpr (N > 0)
+      return s << N;
+    else
+      return s >> -N;
+  }
+  // masks for shifting left or right without wrapping to another row
+  static constexpr Set AllCells = ~Set{0};
+  static constexpr Set NotEdgeColumns = 0x7e7e7e7e7e7e7e7eULL; // 'b' to 'g'
+
+  // 'Bits' wraps a 64-bit mask (like the one returned by 'validMoveBits') and
+  // supports iterating over the positions (from 0 to 63) of the set bits
+  class Bits {
+  public:
+    class Iterator {
+    public:
+      using value_type = size_t;
+      using difference_type = std::ptrdiff_t;
+      constexpr Iterator() noexcept = default;
+      constexpr explicit Iterator(Set mask) noexcept : _mask(mask) {}
+      constexpr auto operator*() const noexcept {
+        return static_cast<size_t>(std::countr_zero(_mask));
+      }
+      constexpr auto& operator++() noexcept {
+        _mask &= _mask - 1; // clear the lowest set bit
+        return *this;
+      }
+      constexpr auto operator++(int) noexcept {
+        auto result = *this;
+        ++*this;
+        return result;
+      }
+      constexpr bool operator==(const Iterator&) const noexcept = default;
+    private:
+      Set _mask = 0;
+    };
+    constexpr explicit Bits(Set mask = 0) noexcept : _mask(mask) {}
+    constexpr auto begin() const noexcept { return Iterator(_mask); }
+    constexpr auto end() const noexcept { return Iterator(); }
+    constexpr auto mask() const noexcept { return _mask; }
+    constexpr auto count() const noexcept { return Board::count(_mask); }
+    constexpr auto empty() const noexcept { return _mask == 0; }
+  private:
+    Set _mask;
+  };
+
   // construct a Board with initial '4 disk' position
-  Board()
-      : _black((1LL << PosE4) | (1LL << PosD5)),
-        _white((1LL << PosD4) | (1LL << PosE5)) {}
+  constexpr Board() noexcept
+      : _black(bit(PosE4) | bit(PosD5)), _white(bit(PosD4) | bit(PosE5)),
+        _hash(calculateHash(_black, _white)) {}
 
   // construct a Board from a char representation where:
   //   . = empty cell
@@ -57,7 +184,7 @@ public:
       : Board(stringLayout, emptyRows * Rows) {}
 
   // operator== is needed for gMock tests
-  auto operator==(const Board& rhs) const {
+  constexpr auto operator==(const Board& rhs) const noexcept {
     return _black == rhs._black && _white == rhs._white;
   }
 
@@ -65,41 +192,57 @@ public:
   std::string toString() const;
 
   // methods used by Score function
-  auto blackCount() const { return _black.count(); }
-  auto whiteCount() const { return _white.count(); }
-  auto black() const { return _black; }
-  auto white() const { return _white; }
+  constexpr auto blackCount() const noexcept { return count(_black); }
+  constexpr auto whiteCount() const noexcept { return count(_white); }
+  constexpr auto black() const noexcept { return _black; }
+  constexpr auto white() const noexcept { return _white; }
 
-  // get list of valid moves for a given color
+  // get list of valid moves for a given color (in position order)
   Moves validMoves(Color) const;
 
-  // fill 'positions' with positions of valid moves and 'boards' with the
-  // corresponding new board for each move and return the total number of valid
-  // moves (method used by ComputerPlayer)
-  size_t validMoves(Color, Boards& boards, Positions& positions) const;
-
-  // search algorithms only need to fill 'positions' for first level so provide
-  // an simpler overload
-  auto validMoves(Color c, Boards& boards) const {
-    size_t count = 0;
-    Board board(*this);
-    for (size_t i = 0; i < Size; ++i)
-      if (!occupied(i) && board.set(i, c)) {
-        assert(count < MaxValidMoves);
-        boards[count++] = board;
-        board = *this;
-      }
-    return count;
+  // get a mask of all valid moves for a given color - the whole board is
+  // processed at once using shifts and masks (instead of checking each cell)
+  constexpr Bits validMoveBits(Color c) const noexcept {
+    return c == Color::Black ? validMoveBits(_black, _white)
+                             : validMoveBits(_white, _black);
   }
 
-  bool hasValidMoves(Color) const;
-  auto hasValidMoves() const {
+  // 'validMoveBits' and 'flips' (cells flipped by playing at empty cell 'pos'
+  // which is 0 if the move isn't valid) also work directly on the cells of the
+  // color to move ('my') and the other color ('op') for searches that don't
+  // need a whole Board (like 'Endgame'). 'flips' uses the current kernel.
+  static constexpr Bits validMoveBits(Set my, Set op) noexcept {
+    const auto moves = validMovesInDirection<-Rows, AllCells>(my, op) |
+                       validMovesInDirection<Rows, AllCells>(my, op) |
+                       validMovesInDirection<-1, NotEdgeColumns>(my, op) |
+                       validMovesInDirection<1, NotEdgeColumns>(my, op) |
+                       validMovesInDirection<-RowAdd1, NotEdgeColumns>(my, op) |
+                       validMovesInDirection<-RowSub1, NotEdgeColumns>(my, op) |
+                       validMovesInDirection<RowSub1, NotEdgeColumns>(my, op) |
+                       validMovesInDirection<RowAdd1, NotEdgeColumns>(my, op);
+    return Bits(moves & ~(my | op));
+  }
+  static Set flips(size_t pos, Set my, Set op);
+
+  // 'children' returns a lazy range of 'Child' values (position and resulting
+  // board) for the valid moves of a color (see 'Children' below). The second
+  // overload visits the positions in the given order (which must all be valid
+  // moves) so it can be combined with a move ordering.
+  struct Child;
+  template<typename R> class Children;
+  auto children(Color) const;
+  template<typename R> auto children(Color, R positions) const;
+
+  constexpr auto hasValidMoves(Color c) const noexcept {
+    return !validMoveBits(c).empty();
+  }
+  constexpr auto hasValidMoves() const noexcept {
     return hasValidMoves(Color::Black) || hasValidMoves(Color::White);
   }
   enum class GameResults { White, Black, Draw };
   GameResults printGameResult(bool tournament = false) const;
-  auto black(size_t i) const { return _black[i]; }
-  auto white(size_t i) const { return _white[i]; }
+  constexpr auto black(size_t i) const noexcept { return test(_black, i); }
+  constexpr auto white(size_t i) const noexcept { return test(_white, i); }
 
   // Set updates Board to reflect the new position (including performing flips)
   // and returns the number of disks that were flipped. If no disks would be
@@ -113,30 +256,265 @@ public:
   //   BadCell: the cell represented by pos is already occupied
   int set(const std::string& pos, Color);
 
-  static auto posToString(size_t pos) {
+  // 'toPos' returns the position (0 to 63) of a string like 'a1' or 'h8' or
+  // BadSize, BadColumn or BadRow (see 'set' above) if it isn't valid
+  static int toPos(const std::string& pos);
+
+  // same as above, but 'pos' is a number from 0 to 63 for an empty cell
+  int set(size_t pos, Color);
+  int set(Move m, Color c) { return set(m.pos(), c); }
+
+  // 'Undo' has what's needed to take back a move made by 'makeMove', i.e., the
+  // cells that were flipped, the cell that was played and the previous hash
+  struct Undo {
+    Set flips;
+    Set hash;
+    uint8_t pos;
+    Color color;
+  };
+
+  // 'makeMove' updates the board in place for a valid move ('pos' should come
+  // from 'validMoveBits') and 'unmakeMove' restores the board to how it was
+  // before the move. These are used by search algorithms to avoid copying the
+  // whole board for each child position.
+  Undo makeMove(size_t pos, Color);
+  constexpr void unmakeMove(const Undo& undo) noexcept {
+    toggle(undo.flips, undo.pos, undo.color);
+    _hash = undo.hash;
+  }
+
+  // 'hash' returns a 64-bit Zobrist hash of the position including the color
+  // to move. It's updated incrementally by 'set' and 'makeMove' using only the
+  // flipped cells and the played cell so calling it is just a lookup.
+  constexpr Set hash(Color toMove) const noexcept {
+    return toMove == Color::Black ? _hash : _hash ^ HashKeys[WhiteToMoveKey];
+  }
+
+  // 'Symmetry' covers the 8 ways of rotating or reflecting a board (which all
+  // lead to equivalent positions). The values are bit flags applied in this
+  // order: 4 = flip across the a1-h8 diagonal, 2 = flip rows (1 <-> 8) and
+  // 1 = flip columns (a <-> h). Rotations are as seen when printing a board
+  // (a1 is the top left corner), e.g., 'RotateClockwise' moves a1 to h1.
+  enum class Symmetry : uint8_t {
+    Identity,
+    FlipColumns,
+    FlipRows,
+    Rotate180,
+    FlipDiagonal,
+    RotateClockwise,
+    RotateCounterClockwise,
+    FlipAntiDiagonal
+  };
+  static constexpr std::array Symmetries = {Symmetry::Identity,
+    Symmetry::FlipColumns, Symmetry::FlipRows, Symmetry::Rotate180,
+    Symmetry::FlipDiagonal, Symmetry::RotateClockwise,
+    Symmetry::RotateCounterClockwise, Symmetry::FlipAntiDiagonal};
+
+  // 'transform' applies a symmetry to all cells of a 'Set' at once using delta
+  // swaps (no per-cell remapping) and 'inverse' returns the symmetry that
+  // undoes it (only the two 90 degree rotations aren't their own inverse)
+  static constexpr Set transform(Set s, Symmetry sym) noexcept {
+    const auto flags = static_cast<uint8_t>(sym);
+    if (flags & 4) {
+      s = deltaSwap<28>(s, 0x00000000f0f0f0f0ULL);
+      s = deltaSwap<14>(s, 0x0000cccc0000ccccULL);
+      s = deltaSwap<7>(s, 0x00aa00aa00aa00aaULL);
+    }
+    if (flags & 2) {
+      s = deltaSwap<32>(s, 0x00000000ffffffffULL);
+      s = deltaSwap<16>(s, 0x0000ffff0000ffffULL);
+      s = deltaSwap<8>(s, 0x00ff00ff00ff00ffULL);
+    }
+    if (flags & 1) {
+      s = deltaSwap<4>(s, 0x0f0f0f0f0f0f0f0fULL);
+      s = deltaSwap<2>(s, 0x3333333333333333ULL);
+      s = deltaSwap<1>(s, 0x5555555555555555ULL);
+    }
+    return s;
+  }
+  static constexpr Symmetry inverse(Symmetry sym) noexcept {
+    return sym == Symmetry::RotateClockwise ? Symmetry::RotateCounterClockwise
+           : sym == Symmetry::RotateCounterClockwise ? Symmetry::RotateClockwise
+                                                     : sym;
+  }
+  // map a single position (0 to 63) through a symmetry
+  static constexpr size_t transformPos(size_t pos, Symmetry sym) noexcept {
+    return static_cast<size_t>(std::countr_zero(transform(bit(pos), sym)));
+  }
+
+  // 'transform' returns the board after applying a symmetry and 'canonical'
+  // returns the smallest of the 8 equivalent boards (comparing Black cells and
+  // then White cells) along with the symmetry that produced it. Results keyed
+  // by the canonical board can be shared by all equivalent positions - use
+  // 'transformPos(pos, inverse(symmetry))' to map a move for the canonical
+  // board back to the original board.
+  Board transform(Symmetry) const;
+  std::pair<Board, Symmetry> canonical() const;
+
+  // kernels that can be used to calculate flips: 'Portable' gathers lines with
+  // shifts and multiplies and works everywhere whereas 'Bmi2' uses PEXT/PDEP
+  // instructions and 'Avx2' floods all 8 directions in parallel using 256-bit
+  // vectors (both of these are only supported on x86 CPUs). All kernels return
+  // the same results.
+  enum class FlipKernel { Portable, Bmi2, Avx2 };
+  static constexpr std::array FlipKernels = {
+    FlipKernel::Portable, FlipKernel::Bmi2, FlipKernel::Avx2};
+
+  // 'flipKernel' returns the kernel currently being used - it's set at startup
+  // to the fastest kernel supported by the CPU
+  static FlipKernel flipKernel();
+
+  // 'setFlipKernel' changes the current kernel (mainly used by tests and
+  // benchmarks) and returns false if the kernel isn't supported by the CPU
+  static bool setFlipKernel(FlipKernel);
+  static bool flipKernelSupported(FlipKernel);
+
+  static std::string posToString(size_t pos) {
     std::string result(1, 'a' + pos % Rows);
     result.push_back('1' + static_cast<char>(pos / Rows));
     return result;
   }
 
-  static bool test(const Set& s, int i) { return s[static_cast<size_t>(i)]; }
-  template<typename... Ts> static bool test(const Set& s, int i, Ts... args) {
-    return test(s, i) || test(s, args...);
-  }
 private:
-  enum PrivateValues { PosD4 = 27, PosE4, PosD5 = 35, PosE5 };
-  bool validMove(size_t pos, const Set& myVals, const Set& opVals) const;
-  bool occupied(size_t pos) const { return _black[pos] || _white[pos]; }
-  int set(size_t pos, Color c) {
-    if (c == Color::Black) return set(pos, _black, _white);
-    return set(pos, _white, _black);
+  enum PrivateValues {
+    PosD4 = 27,
+    PosE4,
+    PosD5 = 35,
+    PosE5,
+    WhiteToMoveKey = Size * 2
+  };
+
+  // random keys used for Zobrist hashing: one key per cell for Black, then one
+  // per cell for White and finally a key used when White is to move. Keys are
+  // generated at compile time (using 'splitmix64') so hashes are the same for
+  // every run.
+  static constexpr auto HashKeys = [] {
+    std::array<Set, WhiteToMoveKey + 1> result{};
+    Set seed = 0;
+    for (auto& key : result) {
+      auto z = seed += 0x9e3779b97f4a7c15ULL;
+      z = (z ^ z >> 30) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ z >> 27) * 0x94d049bb133111ebULL;
+      key = z ^ z >> 31;
+    }
+    return result;
+  }();
+  // a flipped cell changes color so both of its keys are applied. Flips are
+  // hashed a row at a time: 'RowFlipKeys[row][bits]' is the combined key for
+  // flipping 'bits' (one bit per column) in 'row' which keeps the update to 8
+  // table lookups with no loop over individual flipped cells.
+  static constexpr auto RowFlipKeys = [] {
+    std::array<std::array<Set, 256>, Rows> result{};
+    for (size_t row = 0; row < Rows; ++row)
+      for (size_t bits = 0; bits < result[row].size(); ++bits)
+        for (size_t col = 0; col < Rows; ++col)
+          if (bits >> col & 1) {
+            const auto pos = row * Rows + col;
+            result[row][bits] ^= HashKeys[pos] ^ HashKeys[Size + pos];
+          }
+    return result;
+  }();
+  static constexpr Set hashKey(Color c, size_t pos) noexcept {
+    return HashKeys[c == Color::Black ? pos : Size + pos];
+  }
+  static constexpr Set calculateHash(Set black, Set white) noexcept {
+    Set result = 0;
+    for (auto pos : Bits(black)) result ^= hashKey(Color::Black, pos);
+    for (auto pos : Bits(white)) result ^= hashKey(Color::White, pos);
+    return result;
+  }
+
+  // swap the bits in 'Mask' with the bits 'Delta' positions above them
+  template<int Delta> static constexpr Set deltaSwap(Set s, Set mask) noexcept {
+    const auto t = (s ^ s >> Delta) & mask;
+    return s ^ t ^ t << Delta;
   }
-  int set(size_t pos, Set& myVals, Set& opVals);
 
-  Set _black;
-  Set _white;
+  // return the empty cells that are valid moves in one direction (dumb7fill):
+  // flood from 'myVals' over contiguous 'opVals' (at most 6 cells) and then
+  // one more step to find the cell past the end of each run
+  template<int N, Set Mask>
+  static constexpr Set validMovesInDirection(Set myVals, Set opVals) noexcept {
+    const auto op = opVals & Mask;
+    auto flood = op & shift<N>(myVals);
+    for (auto i = 0; i < RowSub2 - 1; ++i) flood |= op & shift<N>(flood);
+    return shift<N>(flood);
+  }
+  constexpr bool occupied(size_t pos) const noexcept {
+    return test(_black | _white, pos);
+  }
+  // flip the cells in 'flips' and toggle 'pos' for color 'c' (used to both
+  // make and unmake a move)
+  constexpr void toggle(Set flips, size_t pos, Color c) noexcept {
+    const auto black = c == Color::Black;
+    auto& myVals = black ? _black : _white;
+    auto& opVals = black ? _white : _black;
+    myVals ^= flips | bit(pos);
+    opVals ^= flips;
+  }
+  // 'play' toggles cells and also updates the hash
+  constexpr void play(Set flips, size_t pos, Color c) noexcept {
+    toggle(flips, pos, c);
+    _hash ^= hashKey(c, pos);
+    for (size_t row = 0; row < Rows; ++row, flips >>= Rows)
+      _hash ^= RowFlipKeys[row][flips & 0xff];
+  }
+
+  Set _black = 0;
+  Set _white = 0;
+  Set _hash = 0;
+};
+
+// 'Child' is the position of a valid move and the board after the move
+struct Board::Child {
+  size_t pos;
+  Board board;
 };
 
+// 'Children' is a range over 'Child' values that only makes the move (finds
+// flips) when an iterator is dereferenced, so a search that stops early (like
+// an alpha-beta cutoff) never pays for the remaining children. Nothing is
+// stored besides the parent board reference and the range of positions.
+template<typename R> class Board::Children {
+public:
+  using PositionIterator = decltype(std::declval<const R&>().begin());
+  class Iterator {
+  public:
+    Iterator(const Board& parent, Color c, PositionIterator i)
+        : _parent(&parent), _color(c), _i(i) {}
+    auto operator*() const {
+      Child result{static_cast<size_t>(*_i), *_parent};
+      result.board.makeMove(result.pos, _color);
+      return result;
+    }
+    auto& operator++() {
+      ++_i;
+      return *this;
+    }
+    bool operator==(const Iterator& rhs) const { return _i == rhs._i; }
+  private:
+    const Board* _parent;
+    Color _color;
+    PositionIterator _i;
+  };
+  Children(const Board& parent, Color c, R positions)
+      : _parent(parent), _color(c), _positions(std::move(positions)) {}
+  auto begin() const { return Iterator(_parent, _color, _positions.begin()); }
+  auto end() const { return Iterator(_parent, _color, _positions.end()); }
+private:
+  const Board& _parent;
+  const Color _color;
+  const R _positions;
+};
+
+inline auto Board::children(Color c) const {
+  return Children<Bits>(*this, c, validMoveBits(c));
+}
+
+template<typename R> auto Board::children(Color c, R positions) const {
+  return Children<R>(*this, c, std::move(positions));
+}
+
 inline constexpr auto* toString(Board::Color c) {
   return c == Board::Color::Black ? "Black" : "White";
 }
@@ -144,6 +522,19 @@ inline auto& operator<<(std::ostream& os, const Board::Color& c) {
   return os << toString(c);
 }
 
+inline constexpr auto* toString(Board::FlipKernel k) {
+  return k == Board::FlipKernel::Portable ? "portable"
+         : k == Board::FlipKernel::Bmi2   ? "bmi2"
+                                          : "avx2";
+}
+inline auto& operator<<(std::ostream& os, const Board::FlipKernel& k) {
+  return os << toString(k);
+}
+
+inline auto& operator<<(std::ostream& os, const Board::Move& m) {
+  return os << m.toString();
+}
+
 // output friendly printing including borders with letters and numbers
 std::ostream& operator<<(std::ostream&, const Board&);
 
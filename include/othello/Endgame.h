@@ -0,0 +1,84 @@
+#pragma once
+
+#include <othello/Board.h>
+
+#include <chrono>
+#include <optional>
+
+namespace othello {
+
+// 'Endgame' is an exact solver for positions near the end of the game: every
+// line is searched to the end of the game so the result is the final disc
+// difference (with perfect play by both colors) instead of a heuristic score.
+// A final disc difference is the number of cells of the color to move minus
+// the number of cells of the other color (empty cells aren't counted).
+//
+// Moves are ordered 'fastest first' (fewest replies for the opponent) when
+// there are many empty cells left and by 'parity' (cells in quadrants with an
+// odd number of empty cells first) near the end. The last 1 to 4 empty cells
+// are handled by special functions that try each empty cell directly instead
+// of generating moves.
+class Endgame {
+public:
+  // 'Exact' finds the final disc difference and 'WinLossDraw' only finds out
+  // if the game is won, lost or drawn (a null window search around 0 which is
+  // much faster)
+  enum class Mode { Exact, WinLossDraw };
+  enum Values {
+    Inf = Board::Size + 1,  // larger than any disc difference
+    FastestFirstEmpties = 7 // use parity ordering at this many empties or less
+  };
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  // if 'deadline' is set then 'solve' stops (and returns 0) once it passes
+  explicit Endgame(std::optional<TimePoint> deadline = {}) noexcept
+      : _deadline(deadline) {}
+
+  // 'solve' returns the final disc difference for 'c' or -1, 0 or 1 (loss,
+  // draw or win) for 'WinLossDraw'
+  int solve(const Board&, Board::Color c, Mode = Mode::Exact);
+
+  // 'solve' for the cells of the color to move ('my') and the other color
+  // ('op') using the alpha-beta window (alpha, beta). The result is 'fail
+  // soft', i.e., if it's <= alpha or >= beta then it's a bound.
+  int solve(Board::Set my, Board::Set op, int alpha, int beta);
+
+  auto nodes() const noexcept { return _nodes; }
+  auto timedOut() const noexcept { return _timeout; }
+private:
+  enum PrivateValues { TimeCheckNodes = 4096 };
+
+  int search(Board::Set my, Board::Set op, int alpha, int beta, bool passed);
+
+  // special cases for the last 1 to 4 empty cells (the positions of the empty
+  // cells are passed in so no move generation is needed)
+  static int solve1(Board::Set my, Board::Set op, size_t x1);
+  int solve2(Board::Set my, Board::Set op, int alpha, int beta, size_t x1,
+             size_t x2, bool passed);
+  int solve3(Board::Set my, Board::Set op, int alpha, int beta, size_t x1,
+             size_t x2, size_t x3, bool passed);
+  int solve4(Board::Set my, Board::Set op, int alpha, int beta, size_t x1,
+             size_t x2, size_t x3, size_t x4, bool passed);
+
+  // 'timeUp' checks the clock about every 'TimeCheckNodes' nodes (the special
+  // cases also count nodes so a modulo check could skip over a multiple)
+  bool timeUp() {
+    if (!_timeout && _deadline && _nodes >= _nextTimeCheck) {
+      _nextTimeCheck = _nodes + TimeCheckNodes;
+      _timeout = std::chrono::steady_clock::now() >= *_deadline;
+    }
+    return _timeout;
+  }
+
+  static int discDifference(Board::Set my, Board::Set op) noexcept {
+    return static_cast<int>(Board::count(my)) -
+           static_cast<int>(Board::count(op));
+  }
+
+  const std::optional<TimePoint> _deadline;
+  long long _nodes = 0;
+  long long _nextTimeCheck = 0;
+  bool _timeout = false;
+};
+
+} // namespace othello
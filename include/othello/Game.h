@@ -6,15 +6,29 @@ namespace othello {
 
 class Game {
 public:
-  Game() : _matches(0), _hasRemotePlayer(false) {}
+  // if 'printStats' is true then search stats are printed for computer players
+  // at the end (along with the total time)
+  explicit Game(bool printStats = false)
+      : _matches(0), _hasRemotePlayer(false), _printStats(printStats) {}
+
+  // the second constructor plays 'matches' games between 'black' and 'white'
+  // without prompting (used by tests and tools)
+  Game(std::unique_ptr<Player> black, std::unique_ptr<Player> white,
+       size_t matches, bool printStats = false)
+      : _matches(matches), _hasRemotePlayer(false), _printStats(printStats) {
+    _players.emplace_back(std::move(black));
+    _players.emplace_back(std::move(white));
+  }
 
   // 'begin' prompts for number of matches (for a 'tournament') and player
-  // types, then starts the game(s) matches is 0 for a non-tournament style
-  // interactive game (showing the board each turn)
+  // types (unless players were passed to the constructor), then starts the
+  // game(s) matches is 0 for a non-tournament style interactive game (showing
+  // the board each turn)
   void begin();
 private:
   static char getChar(Board::Color, const std::string&, const std::string&,
                       bool(char), char);
+  static size_t getNumber(Board::Color, const std::string&, size_t);
   Board playOneGame();
 
   // createPlayer also updates _matches and _tournament depending on user input
@@ -22,7 +36,9 @@ private:
 
   size_t _matches;
   bool _hasRemotePlayer;
+  const bool _printStats;
   std::vector<std::unique_ptr<Player>> _players;
+  std::vector<std::shared_ptr<SearchCache>> _caches;
 };
 
 } // namespace othello
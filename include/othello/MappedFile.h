@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace othello {
+
+// 'MappedFile' maps a whole file into memory (read-only) and removes the
+// mapping when it's destroyed. 'data' is null if the file couldn't be mapped
+// (or if it's empty). Replacing the file (by renaming a new file over it)
+// doesn't affect an existing mapping.
+class MappedFile {
+public:
+  MappedFile() noexcept = default;
+  explicit MappedFile(const std::string& file);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  auto data() const noexcept { return static_cast<const char*>(_data); }
+  auto size() const noexcept { return _size; }
+private:
+  void* _data = nullptr;
+  size_t _size = 0;
+};
+
+} // namespace othello
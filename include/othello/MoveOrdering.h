@@ -0,0 +1,57 @@
+#pragma once
+
+#include <othello/Board.h>
+
+namespace othello {
+
+// 'MoveOrdering' sorts the valid moves of a position so that alpha-beta search
+// tries the moves most likely to cause a cutoff first. Moves are ordered by:
+// - the best move found by a previous search (from the transposition table)
+// - 'killer' moves: moves that recently caused a cutoff at the same ply
+// - history: moves that caused cutoffs anywhere in the search (weighted by the
+//   depth of the cutoff)
+// - a cheap static value: corners first, cells next to empty corners last and
+//   (when there is enough depth left to make it worth it) fewer replies for
+//   the opponent
+// Killers and history are updated by calling 'cutoff' during a search.
+class MoveOrdering {
+public:
+  enum Values {
+    Killers = 2,
+    MaxPly = Board::Size,
+    MobilityDepth = 3, // minimum depth for counting opponent replies
+    MaxHistory = 1 << 20
+  };
+  static constexpr uint8_t NoMove = Board::Size;
+
+  MoveOrdering() noexcept;
+
+  // 'order' returns 'validMoves' (the valid moves of 'c') in the order they
+  // should be searched. 'ply' is the distance from the root of the search,
+  // 'depth' is the remaining depth to search and 'tableMove' is the best move
+  // from the transposition table (or 'NoMove').
+  Board::Moves order(const Board&, Board::Color c, Board::Bits validMoves,
+                     size_t ply, size_t depth,
+                     size_t tableMove = NoMove) const;
+
+  // 'cutoff' records that 'pos' caused a cutoff for 'c' at 'ply'
+  void cutoff(Board::Color c, size_t ply, size_t pos, size_t depth) noexcept;
+
+  // 'newSearch' clears killers and ages history values (so moves that were
+  // good in the previous search are still tried earlier)
+  void newSearch() noexcept;
+
+  // 'killer' and 'history' are mainly for testing
+  auto killer(size_t ply, size_t i) const noexcept { return _killers[ply][i]; }
+  auto history(Board::Color c, size_t pos) const noexcept {
+    return _history[static_cast<size_t>(c)][pos];
+  }
+private:
+  int score(const Board&, Board::Color, size_t pos, size_t ply,
+            size_t depth) const;
+
+  std::array<std::array<uint8_t, Killers>, MaxPly> _killers{};
+  std::array<std::array<int, Board::Size>, Board::Colors.size()> _history{};
+};
+
+} // namespace othello
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <othello/Board.h>
+#include <othello/MappedFile.h>
+
+#include <optional>
+#include <span>
+#include <string>
+
+namespace othello {
+
+// 'OpeningBook' is a read-only set of positions with a best move and score.
+// Positions are stored by the hash of their canonical board (see
+// 'Board::canonical') so one entry covers all 8 equivalent positions. The file
+// is memory mapped (so opening a book doesn't read it) and looked up using a
+// binary search. The file format is a 'Header' followed by 'Entry' values
+// sorted by hash (in the native byte order).
+class OpeningBook {
+public:
+  // 'move' is for the canonical board, 'depth' is the depth of the search that
+  // found it and 'score' is from the point of view of the color to move
+  struct Entry {
+    Board::Set hash;
+    int32_t score;
+    uint8_t move;
+    uint8_t depth;
+    uint16_t reserved = 0;
+  };
+  static_assert(sizeof(Entry) == 16);
+
+  struct Header {
+    std::array<char, 8> magic;
+    uint64_t entries;
+  };
+  static constexpr std::array<char, 8> Magic = {
+    'O', 'T', 'H', 'B', 'O', 'O', 'K', '1'};
+
+  // an empty book has no entries (also used if 'file' can't be opened or
+  // isn't a valid book)
+  OpeningBook() noexcept = default;
+  explicit OpeningBook(const std::string& file);
+
+  // 'key' returns the hash used to store 'board' with 'c' to move
+  static Board::Set key(const Board& board, Board::Color c) {
+    return board.canonical().first.hash(c);
+  }
+
+  // 'find' returns the entry for 'key' (if there is one)
+  std::optional<Entry> find(Board::Set key) const noexcept;
+
+  // 'move' returns the book move for 'c' on 'board' (mapped back from the
+  // canonical board) if the position is in the book and the move is valid
+  std::optional<size_t> move(const Board& board, Board::Color c) const;
+
+  // 'write' sorts 'entries' by hash and writes them to 'file' (entries with
+  // the same hash as an earlier entry are dropped). Returns false if the file
+  // couldn't be written.
+  static bool write(const std::string& file, std::vector<Entry> entries);
+
+  auto size() const noexcept { return _entries.size(); }
+  auto empty() const noexcept { return _entries.empty(); }
+private:
+  const MappedFile _file;
+  std::span<const Entry> _entries;
+};
+
+} // namespace othello
@@ -1,8 +1,20 @@
 #pragma once
 
+#include <othello/Endgame.h>
+#include <othello/MoveOrdering.h>
+#include <othello/OpeningBook.h>
+#include <othello/ProbCut.h>
 #include <othello/Score.h>
+#include <othello/SearchCache.h>
+#include <othello/SearchStats.h>
+#include <othello/TranspositionTable.h>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <optional>
+#include <thread>
 
 #include <boost/asio.hpp>
 
@@ -10,15 +22,15 @@ namespace othello {
 
 class Player {
 public:
-  using Move = std::optional<std::string>;
+  using Move = std::optional<Board::Move>;
   static std::unique_ptr<Player> createPlayer(Board::Color,
                                               bool computerOnly = false);
 
   Player(const Player&) = delete;
   virtual ~Player() = default;
 
-  // 'move' returns the string representation of the move that was made or empty
-  // string if player wants to end the game. prevMoves is passed in to this
+  // 'move' returns the move that was made or an empty value if the player
+  // wants to end the game. prevMoves is passed in to this
   // method so it can be sent to a remote player if needed. Setting tournament
   // to 'true' suppresses printing board each time. Note: move is only called if
   // valid moves exist for this player's color Note: prevMoves will be empty if
@@ -32,11 +44,18 @@ public:
   virtual void gameOver(const Board&,
                         const Board::Moves& = Board::Moves()) const {}
 
+  // 'opponentMoved' is called once the other player has made its move so a
+  // player that searches during the other player's turn can stop
+  virtual void opponentMoved() const {}
+
   // 'printTotalTime' prints the total time taken in seconds to make moves by
   // this player Mote: time is internally measured in nanoseconds, but rounded
   // to nearest microsecond when printing
   void printTotalTime() const;
 
+  // 'printStats' prints search statistics (if the player has any)
+  virtual void printStats() const {}
+
   const Board::Color color;
   virtual std::string toString() const { return othello::toString(color); }
 protected:
@@ -60,57 +79,372 @@ private:
 
 class ComputerPlayer : public Player {
 public:
+  // 'TimeControl' limits how long a move can take by using iterative deepening
+  // (searching to depth 1, then 2, etc. until time runs out) instead of always
+  // searching to a fixed depth. 'PerMove' gives every move the same amount of
+  // time and 'PerGame' is a clock for all moves in a game (remaining time is
+  // split across the expected number of moves left). The default value ('{}')
+  // is 'None'.
+  struct TimeControl {
+    enum class Type { None, PerMove, PerGame };
+    Type type;
+    std::chrono::milliseconds time;
+  };
+
+  // 'Parallel' says how more than one search thread is used:
+  // - 'RootSplit' shares out root moves between the threads
+  // - 'LazySmp' runs the same search on every thread (helper threads use
+  //   staggered depths and root move orders) and results are shared through
+  //   the transposition table. The result from the calling thread is used.
+  // - 'Ybwc' (Young Brothers Wait Concept) splits the search below the root:
+  //   once the first move of a node has been searched (without a cutoff) the
+  //   rest of the moves ('young brothers') can be stolen by idle threads
+  enum class Parallel { RootSplit, LazySmp, Ybwc };
+
+  // 'EndgameControl' switches from the heuristic search to the exact 'Endgame'
+  // solver once there are 'empties' (or fewer) empty cells. 'mode' chooses
+  // between playing for the best final disc difference ('Exact') or just for a
+  // win or draw ('WinLossDraw' which is faster). The default value ('{}') never
+  // uses the solver.
+  struct EndgameControl {
+    size_t empties;
+    Endgame::Mode mode;
+  };
+
+  // 'Options' has the optional settings of a player (set the ones that are
+  // needed using designated initializers, i.e., '{.threads = 4}'):
+  // - 'timeControl' (see above) limits the time taken by each move
+  // - 'tableMegabytes' is the size of the transposition table used to reuse
+  //   results for positions that can be reached by different move orders (0
+  //   turns off the table)
+  // - 'moveOrdering' can be set to false to search moves in position order
+  //   (after the table move) which is mainly used to compare node counts
+  // - 'threads' is the number of search threads and 'parallel' says how they
+  //   are used
+  // - 'endgame' says when to switch to an exact search to the end of the game
+  // - if 'ponder' is true then the search continues on a background thread
+  //   during the other player's turn
+  // - if the position is in 'book' then the book move is played without
+  //   searching
+  // - search results are saved in (and reused from) 'cache' if it was created
+  //   for the same score type, search depth and selectivity (otherwise it
+  //   isn't used)
+  // - 'selectivity' turns on Multi-ProbCut pruning (see 'ProbCut') where
+  //   higher levels are faster, but less accurate (0 is a full-width search)
+  struct Options {
+    TimeControl timeControl{};
+    size_t tableMegabytes = TranspositionTable::DefaultMegabytes;
+    bool moveOrdering = true;
+    size_t threads = 1;
+    Parallel parallel = Parallel::RootSplit;
+    EndgameControl endgame{};
+    bool ponder = false;
+    std::shared_ptr<const OpeningBook> book{};
+    std::shared_ptr<SearchCache> cache{};
+    size_t selectivity = 0;
+  };
+
+  // 'search' is the depth to search or the maximum depth when a time control
+  // is used. If 'random' is true then a move is chosen at random when more
+  // than one move has the best score. The first constructor uses the default
+  // 'Options' (a default argument can't be used for a nested struct with
+  // member initializers).
   ComputerPlayer(Board::Color c, size_t search, bool random,
                  std::shared_ptr<Score> score)
+      : ComputerPlayer(c, search, random, std::move(score), Options{}) {}
+  ComputerPlayer(Board::Color c, size_t search, bool random,
+                 std::shared_ptr<Score> score, Options options)
       : Player(c), opColor(Board::opColor(c)), _search(search), _random(random),
-        _score(std::move(score)){};
+        _score(std::move(score)), _timeControl(options.timeControl),
+        _moveOrdering(options.moveOrdering), _parallel(options.parallel),
+        _endgame(options.endgame), _ponder(options.ponder),
+        _book(std::move(options.book)),
+        _cache(options.cache && _score &&
+                   options.cache->config() ==
+                     SearchCache::config(*_score, search, options.selectivity)
+                 ? std::move(options.cache)
+                 : nullptr),
+        _probCut(_score ? ProbCut(*_score, options.selectivity) : ProbCut()),
+        _searchFunctions(searchFor(_score.get())),
+        _table(options.tableMegabytes),
+        _workers(std::max<size_t>(options.threads, 1)){};
+  ~ComputerPlayer() override { stopPondering(); }
+  void gameOver(const Board&, const Board::Moves&) const override;
+  void opponentMoved() const override { stopPondering(); }
+  void printStats() const override;
   std::string toString() const override;
+
+  // 'lastMoveStats' has the search statistics for the last move and
+  // 'totalStats' has totals for all moves made by this player (including any
+  // searching done while pondering)
+  SearchStats lastMoveStats() const;
+  SearchStats totalStats() const;
+
+  // 'totalNodes' is the number of positions searched by 'negamax' (not
+  // including leaf positions which are counted by 'totalScoreCalls')
+  auto totalScoreCalls() const { return totalStats().leaves; }
+  auto totalNodes() const { return totalStats().nodes; }
+  auto threads() const { return _workers.size(); }
+  // 'ponderHits' is the number of moves made from a position that was searched
+  // while pondering and 'bookMoves' is the number of moves found in the book
+  auto ponderHits() const { return _ponderHits; }
+  auto bookMoves() const { return _bookMoves; }
+  // 'cacheHits' is the number of moves found in the search cache
+  auto cacheHits() const { return _cacheHits; }
+
+  // 'analyze' searches 'board' the same way as 'makeMove' (without using the
+  // book) and returns the best move (the first in position order if more than
+  // one move has the best score) and its score (see 'rootScore' below)
+  std::pair<size_t, int> analyze(const Board&) const;
 private:
-  using Moves = std::vector<size_t>;
-  enum Values { Min = -Score::Win - 1, Max = Score::Win + 1 };
+  using Moves = Board::Moves;
+  enum Values {
+    Min = -Score::Win - 1,
+    Max = Score::Win + 1,
+    AspirationWindow = 32, // initial root window around a previous score
+    SplitDepth = 3,        // minimum depth for searching with 'threads'
+    MinSplitDepth = 4,     // minimum depth of a YBWC split point
+    TimeCheckNodes = 1024
+  };
 
   // 'makeMove' gets the set of valid moves if search = 0 or calls 'findMoves'
   // when search > 0 and makes either the first move in the list or a randomly
   // chosen one if _random is true Note: ComputerPlayer version of 'makeMove'
-  // always returns a move (never empty string). 'flips' should be a positive
+  // always returns a move (never an empty value). 'flips' should be a positive
   // number if the move was valid or a negaive number for an error (like
   // BadCell, BadColumn, etc.)
   Move makeMove(Board&, const Board::Moves&, int& flips) const override;
 
-  // 'findMoves' returns one or more 'best' moves (based on minMax and values
-  // returned from '_score')
-  Board::Moves findMoves(const Board&) const;
+  // 'SplitPoint' is a node that's being searched by more than one thread
+  // (YBWC). 'alpha', 'best' and 'bestMove' are protected by 'mutex' and
+  // 'cutoff' is set when a move fails high so threads searching other moves
+  // (or anything below them) can stop.
+  struct SplitPoint {
+    const SplitPoint* const parent;
+    const Board board;
+    const Board::Color turn;
+    const size_t depth, moves, rootDepth;
+    const int beta;
+    int alpha, best;
+    size_t bestMove;
+    std::atomic<size_t> pending; // tasks that haven't finished
+    std::atomic<bool> cutoff = false;
+    std::mutex mutex{};
+  };
+
+  // 'Task' is a move at a split point that can be searched by any thread
+  // ('index' is the position of the move in the search order of the node)
+  struct Task {
+    SplitPoint* splitPoint;
+    size_t pos, index;
+  };
+
+  // 'Worker' is the state used by one search thread: move ordering data (which
+  // is updated on every cutoff so it isn't shared), the depth of its current
+  // root search (used to get the 'ply' of a node) and statistics that are
+  // added to the stats for the move when the thread finishes searching. For
+  // YBWC, 'tasks' is a deque of moves from split points created by this thread
+  // (it takes tasks from the back and other threads steal from the front) and
+  // 'splitPoint' is the split point of the task it's searching.
+  struct Worker {
+    MoveOrdering ordering;
+    size_t rootDepth = 0;
+    SearchStats stats;
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    const SplitPoint* splitPoint = nullptr;
+  };
+
+  // 'ponder' starts searching (on '_ponderThread') the position after the
+  // other player's expected reply to 'board' (the move stored in the table) or
+  // the positions after all replies if there isn't one. Results are shared with
+  // the next search through the table and the main worker's move ordering.
+  void ponder(const Board&) const;
+  void stopPondering() const;
+
+  // 'findMoves' returns one or more 'best' moves (based on negamax and values
+  // returned from '_score'). If there's a time control then searches are done
+  // with increasing depth and the moves from the last completed depth are
+  // returned. When there's more than one thread:
+  // - 'RootSplit': the first root move is searched by the calling thread and
+  //   then the other root moves are shared out between the threads (using the
+  //   best score found so far by any thread as the bound for the next move)
+  // - 'LazySmp': helper threads search with increasing depth (starting at 1
+  //   or 2) until the calling thread's search is done
+  // - 'Ybwc': helper threads steal tasks until the calling thread's search is
+  //   done
+  // Move ordering data from pondering is kept if 'ponderHit' is true.
+  Board::Moves findMoves(const Board&, bool ponderHit = false) const;
+
+  // 'Search' has the versions of the search functions compiled for one 'Score'
+  // type 'S'. All of the functions called by them ('negamax', 'split', etc.)
+  // are templates as well so scoring leaf positions has no virtual calls (see
+  // 'Score::staticScore') unless 'S' is 'Score'.
+  struct Search {
+    Board::Moves (ComputerPlayer::*findMoves)(Worker&, const Board&,
+                                              size_t) const;
+    void (ComputerPlayer::*runTask)(Worker&, const Task&) const;
+  };
+
+  // 'searchFor' returns the functions for the type of 'score' which is chosen
+  // once when a player is created: 'FullScore' and 'WeightedScore' have their
+  // own versions and any other type (like a mock) uses 'Score'
+  static const Search& searchFor(const Score* score);
+
+  // 'findMoves' and 'runTask' call the versions for the score type of this
+  // player (search code calls the templates directly)
+  Board::Moves findMoves(Worker& w, const Board& board, size_t depth) const {
+    return (this->*_searchFunctions.findMoves)(w, board, depth);
+  }
+  void runTask(Worker& w, const Task& task) const {
+    (this->*_searchFunctions.runTask)(w, task);
+  }
+  template<typename S>
+  Board::Moves findMoves(Worker&, const Board&, size_t depth) const;
+
+  // 'endgameMoves' returns the best moves based on 'Endgame' results (exact
+  // final disc differences or win, loss or draw) or an empty list if the
+  // deadline passed before all moves were solved
+  Board::Moves endgameMoves(const Board&) const;
+
+  // 'moveTime' returns how much time the next move can take (based on the time
+  // control and the number of empty cells left on the board)
+  std::chrono::nanoseconds moveTime(const Board&) const;
+
+  // 'stopped' returns true if the search done by 'w' should stop (without
+  // storing results) because time ran out, because pondering was stopped,
+  // because 'w' is a helper and the main search is done or because another
+  // thread found a cutoff at a split point above the node 'w' is searching
+  bool stopped(const Worker& w) const {
+    if (_timeout || _stopPonder || _stopHelpers && &w != &_workers.front())
+      return true;
+    for (auto i = w.splitPoint; i; i = i->parent)
+      if (i->cutoff) return true;
+    return false;
+  }
+
+  // 'timeUp' is called for each node - during a timed search it checks the
+  // clock every 'TimeCheckNodes' calls and once the deadline has passed it
+  // keeps returning true (for all threads)
+  bool timeUp(const Worker& w) const {
+    if (!_timeout && _deadline && w.stats.nodes % TimeCheckNodes == 0 &&
+        std::chrono::steady_clock::now() >= *_deadline)
+      _timeout = true;
+    return stopped(w);
+  }
+
+  // 'addTotals' adds the stats from 'w' to the stats for the current move (and
+  // resets them) - this is safe to call from any thread
+  void addTotals(Worker& w) const {
+    const std::lock_guard lock(_statsMutex);
+    _moveStats += w.stats;
+    w.stats = {};
+  }
+
+  // 'negamax' is a Principal Variation Search (alpha-beta where all scores are
+  // from the point of view of the color to move and moves after the first are
+  // searched with a null window). Moves are made and unmade in place so
+  // 'board' is the same when it returns. Results are stored in '_table' and a
+  // stored result is returned if it was searched at least as deep and its
+  // bound is good enough for the current alpha-beta window. Moves are searched
+  // in the order returned by the worker's 'ordering' and moves that cause a
+  // cutoff are passed back to it.
+  template<typename S>
+  int negamax(Worker&, Board&, size_t depth, Board::Color, size_t, int,
+              int) const;
+
+  // 'probCut' is used by 'negamax' when selectivity is on: it does the
+  // shallow searches for the checks of 'depth' and returns 'beta' (or 'alpha')
+  // if one of them predicts the deep search would fail high (or low)
+  template<typename S>
+  std::optional<int> probCut(Worker&, Board&, size_t depth, Board::Color,
+                             size_t prevMoves, int alpha, int beta) const;
+
+  // 'split' is used by 'negamax' for YBWC: it adds 'brothers' (the moves after
+  // the first move at a node) as tasks for this thread and other threads to
+  // search and then updates 'alpha', 'best' and 'bestMove' once they are done
+  template<typename S>
+  void split(Worker&, const Board&, Board::Color, size_t depth, size_t moves,
+             int& alpha, int beta, int& best, size_t& bestMove,
+             const Moves& brothers) const;
+
+  // 'runTask' searches the move for a task (with a null window first the same
+  // way as 'negamax') and updates its split point
+  template<typename S> void runTask(Worker&, const Task&) const;
 
-  // 'minMax' is the recursize min-max algorithm with alpha-beta pruning
-  int minMax(const Board&, size_t depth, Board::Color, size_t, int, int) const;
+  // 'popTask' returns the last task of 'w' if it's for 'splitPoint' and
+  // 'stealTask' returns the first task of another thread (that's below
+  // 'splitPoint' unless it's null)
+  static std::optional<Task> popTask(Worker& w, const SplitPoint* splitPoint);
+  std::optional<Task> stealTask(const Worker& w,
+                                const SplitPoint* splitPoint) const;
 
-  // 'updateMoves' is used by 'findMoves' to work with sets of moves with the
-  // same score value
+  // 'updateMoves' is used by 'findMoves' to work with sets of moves (positions)
+  // with the same score value
   static void updateMoves(int score, size_t move, int& best, Moves& moves) {
     if (score > best) {
       best = score;
       moves.clear();
-      moves.push_back(move);
+      moves.emplace_back(move);
     } else if (score == best)
-      moves.push_back(move);
+      moves.emplace_back(move);
   }
 
-  // 'callScore' and 'callMinMax' are used by 'findMove' and 'minMax'
-  auto callScore(const Board& board) const {
-    ++_totalScoreCalls;
-    return _score->score(board, color);
+  // 'callScore' and 'callNegamax' are used by 'findMove' and 'negamax'.
+  // 'callScore' is always from this player's point of view whereas
+  // 'callNegamax' is from the point of view of 'turn'.
+  template<typename S> int callScore(Worker& w, const Board& board) const {
+    ++w.stats.leaves;
+    if constexpr (std::is_same_v<S, Score>)
+      return _score->score(board, color);
+    else
+      return Score::staticScore(static_cast<const S&>(*_score), board, color);
   }
-  auto callMinMax(const Board& board, size_t depth, Board::Color turn,
+  template<typename S>
+  int callNegamax(Worker& w, Board& board, size_t depth, Board::Color turn,
                   size_t prevMoves, int alpha, int beta) const {
-    if (depth) return minMax(board, depth, turn, prevMoves, alpha, beta);
-    return callScore(board);
+    if (depth)
+      return negamax<S>(w, board, depth, turn, prevMoves, alpha, beta);
+    return turn == color ? callScore<S>(w, board) : -callScore<S>(w, board);
   }
 
   const Board::Color opColor;
   const size_t _search;
   const bool _random;
   const std::shared_ptr<Score> _score;
-  mutable long long _totalScoreCalls = 0;
+  const TimeControl _timeControl;
+  const bool _moveOrdering;
+  const Parallel _parallel;
+  const EndgameControl _endgame;
+  const bool _ponder;
+  const std::shared_ptr<const OpeningBook> _book;
+  const std::shared_ptr<SearchCache> _cache;
+  const ProbCut _probCut;
+  const Search& _searchFunctions;
+  mutable TranspositionTable _table;
+  // search threads (the first one is used by the thread calling 'findMoves')
+  mutable std::vector<Worker> _workers;
+  // '_moveStats' collects stats from all threads for the current move (or for
+  // pondering after a move is made) and is protected by '_statsMutex'
+  mutable std::mutex _statsMutex;
+  mutable SearchStats _moveStats, _lastMoveStats, _totalStats;
+  mutable std::atomic<bool> _stopHelpers = false;
+  // state used for time controls: time used in the current game and the
+  // deadline for the current search (if there is one)
+  mutable std::chrono::nanoseconds _gameTime{0};
+  mutable std::optional<std::chrono::steady_clock::time_point> _deadline;
+  mutable std::atomic<bool> _timeout = false;
+  // state used for pondering: the positions being searched and the thread
+  // searching them
+  mutable std::vector<Board> _ponderBoards;
+  mutable std::thread _ponderThread;
+  mutable std::atomic<bool> _stopPonder = false;
+  mutable size_t _ponderHits = 0;
+  mutable size_t _bookMoves = 0;
+  mutable size_t _cacheHits = 0;
+  // '_rootScore' is the score of the best move from the last search done by
+  // the calling thread (a final disc difference if the endgame solver is used)
+  mutable int _rootScore = 0;
 };
 
 class RemotePlayer : public Player {
@@ -133,7 +467,7 @@ private:
   }
   void send(const Board::Moves& moves) const {
     std::string out;
-    for (auto& s : moves) out += s;
+    for (auto m : moves) out += m.toString();
     send(out);
   }
   void opFailed(const char* msg) const;
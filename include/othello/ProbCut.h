@@ -0,0 +1,77 @@
+#pragma once
+
+#include <othello/Score.h>
+
+#include <span>
+#include <vector>
+
+namespace othello {
+
+// 'ProbCut' has the parameters for Multi-ProbCut (a selective search): the
+// score of a deep search of a position is predicted from the score of a
+// shallow search using 'a * shallow + b' where 'sigma' is the standard
+// deviation of the error. If a shallow search shows that the deep score is
+// very likely to be outside the alpha-beta window then the deep search can be
+// skipped. A 'Check' is one of these predictions and there's one for each
+// depth from 'MinDepth' to 'MaxDepth' and each game 'stage' (scores change a
+// lot more later in the game so one set of parameters doesn't work well for
+// every position). There can be more than one check for a depth and stage in
+// which case cheaper checks should come first. Parameters are fitted for each
+// 'Score' type by 'othello_probcut' (see 'Calibrations' in ProbCut.cpp).
+class ProbCut {
+public:
+  struct Check {
+    size_t stage, depth, shallow;
+    double a, b, sigma;
+  };
+  enum Values {
+    MinDepth = 3,
+    MaxDepth = 10,
+    Stages = 4,
+    StageMoves = 15, // moves played in each stage (the last stage has the rest)
+    MaxSelectivity = 4
+  };
+
+  // 'Thresholds' has the number of standard deviations a prediction must be
+  // outside the window to prune for each selectivity level (0 never prunes)
+  static constexpr std::array<double, MaxSelectivity + 1> Thresholds = {
+    0, 1.5, 1.2, 0.9, 0.6};
+
+  // 'stage' returns the game stage of 'board' (based on the number of moves
+  // that have been played)
+  static size_t stage(const Board& board) noexcept {
+    const auto moves = board.blackCount() + board.whiteCount() - 4;
+    return std::min<size_t>(moves / StageMoves, Stages - 1);
+  }
+
+  // 'shallowDepth' returns the depth of the shallow search used to predict a
+  // search of 'depth' (or 0 if 'depth' isn't checked). It's about half of
+  // 'depth' with the same parity since scores at odd and even depths are
+  // quite different.
+  static size_t shallowDepth(size_t depth) noexcept;
+
+  // 'fit' returns the 'Check' for 'stage', 'depth' and 'shallow' found using a
+  // least squares fit of 'samples' (pairs of shallow and deep scores). 'a' is
+  // 1 and 'b' is 0 if there are less than 3 samples.
+  static Check fit(size_t stage, size_t depth, size_t shallow,
+                   const std::vector<std::pair<int, int>>& samples);
+
+  // the default value never prunes, the second constructor uses the checks
+  // calibrated for 'score' (if there are any) and the third uses 'checks'
+  ProbCut() noexcept = default;
+  ProbCut(const Score& score, size_t selectivity);
+  ProbCut(std::vector<Check> checks, size_t selectivity);
+
+  // 'checks' returns the checks for 'depth' in 'stage' (empty if there aren't
+  // any)
+  std::span<const Check> checks(size_t stage, size_t depth) const noexcept;
+
+  auto selectivity() const noexcept { return _selectivity; }
+  auto threshold() const noexcept { return Thresholds[_selectivity]; }
+  bool enabled() const noexcept { return _selectivity && !_checks.empty(); }
+private:
+  size_t _selectivity = 0;
+  std::vector<Check> _checks; // sorted by stage and then depth
+};
+
+} // namespace othello
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <othello/Board.h>
+
+#include <random>
+
+namespace othello {
+
+// 'randomMove' plays a random valid move (chosen using 'gen') for 'c' or for
+// the other color if 'c' has no valid moves and then sets 'c' to the color
+// that moves next. It returns false (without changing 'board') if neither
+// color can move. Tests and tools use it with a fixed seed to make repeatable
+// positions.
+inline bool randomMove(Board& board, Board::Color& c, std::mt19937& gen) {
+  auto moves = board.validMoveBits(c);
+  if (moves.empty()) {
+    moves = board.validMoveBits(Board::opColor(c));
+    if (moves.empty()) return false;
+    c = Board::opColor(c);
+  }
+  auto move = moves.begin();
+  for (auto i = gen() % moves.count(); i > 0; --i) ++move;
+  board.set(*move, c);
+  c = Board::opColor(c);
+  return true;
+}
+
+// 'randomBoard' plays random moves from the initial board until there are
+// 'empties' empty cells left (or the game ends) and sets 'c' to the color to
+// move next
+inline Board randomBoard(std::mt19937& gen, size_t empties, Board::Color& c) {
+  Board board;
+  c = Board::Color::Black;
+  while (Board::Size - board.blackCount() - board.whiteCount() > empties &&
+         randomMove(board, c, gen)) {}
+  return board;
+}
+
+} // namespace othello
@@ -23,58 +23,69 @@ public:
              : scoreBoard(board, board.white(), board.black(), debugPrint);
   }
 
+  // 'staticScore' returns the same value as 'score' for 'T' (a final class
+  // derived from 'Score'), but without any virtual calls so 'scoreCell' is
+  // inlined into the loop over the cells. It's used by 'ComputerPlayer' to
+  // score leaf positions (see 'scoreCells' instantiations in Score.cpp).
+  template<typename T>
+  static int staticScore(const T& s, const Board& board, Board::Color c) {
+    const auto black = c == Board::Color::Black;
+    const auto myVals = black ? board.black() : board.white(),
+               opVals = black ? board.white() : board.black();
+    return board.hasValidMoves()
+             ? scoreCells(s, myVals, opVals, ~(myVals | opVals))
+             : finalScore(myVals, opVals);
+  }
+
   virtual std::string toString() const = 0;
 private:
   // return a score for the given board which could be Win, -Win (loss), 0 (for
   // a draw) or a total of cell scores
-  virtual int scoreBoard(const Board& board, const Board::Set& myVals,
-                         const Board::Set& opVals, bool debugPrint) const {
+  virtual int scoreBoard(const Board& board, Board::Set myVals,
+                         Board::Set opVals, bool debugPrint) const {
     if (board.hasValidMoves()) {
-      const auto empty = (myVals | opVals).flip();
+      const auto empty = ~(myVals | opVals);
       return debugPrint ? printScoreCells(myVals, opVals, empty)
-                        : scoreCells(myVals, opVals, empty);
+                        : scoreCells(*this, myVals, opVals, empty);
     }
-    const auto myCount = myVals.count(), opCount = opVals.count();
+    return finalScore(myVals, opVals);
+  }
+
+  // 'finalScore' returns the score of a finished game
+  static int finalScore(Board::Set myVals, Board::Set opVals) {
+    const auto myCount = Board::count(myVals), opCount = Board::count(opVals);
     return myCount > opCount ? Win : myCount < opCount ? -Win : 0;
   }
 
-  // loop through each cell and calculate the aggregate score:
+  // loop through each non-empty cell and calculate the aggregate score:
   //   Add to total if cell contains my color
   //   Subtract from total if cell contains opposite color
-  int scoreCells(const Board::Set& myVals, const Board::Set& opVals,
-                 const Board::Set& empty) const {
-    auto result = 0;
-    for (size_t row = 0, pos = 0; row < Board::Rows; ++row)
-      for (size_t col = 0; col < Board::Rows; ++col, ++pos)
-        if (myVals[pos])
-          result += scoreCell(row, col, pos, myVals, opVals, empty);
-        else if (opVals[pos])
-          result -= scoreCell(row, col, pos, opVals, myVals, empty);
-    return result;
-  }
+  // 'T' is 'Score' for virtual calls to 'scoreCell' or a final class (this is
+  // defined and explicitly instantiated in Score.cpp)
+  template<typename T>
+  static int scoreCells(const T& s, Board::Set myVals, Board::Set opVals,
+                        Board::Set empty);
 
   // print the score of each cell in a grid to help testing:
   // - Scores for opposite color are inside ()
   // - Empty cells show '....' to help distinguish them from a '0' score value
   // - Prints totals for my color and oppsite color below the grid
   // - Asserts totals match result from calling non-debug 'scoreCells'
-  int printScoreCells(const Board::Set&, const Board::Set&,
-                      const Board::Set&) const;
+  int printScoreCells(Board::Set, Board::Set, Board::Set) const;
 
   // scoreCell is called for each non-empty cell and is passed the following:
   // - row: row of the cell (from 0 to 7)
   // - col: column of the cell (from 0 to 7)
   // - pos: the position on the board (from 0 to 63)
-  // - myVals: bitset<64> with values set to true for same color positions (as
-  //   the cell being scored)
-  // - opVals: bitset<64> with values set to true for opposite color positions
-  // - empty: bitset<64> with values set to true for empty positions
-  virtual int scoreCell(size_t row, size_t col, size_t pos,
-                        const Board::Set& myVals, const Board::Set& opVals,
-                        const Board::Set& empty) const = 0;
+  // - myVals: 64-bit mask with bits set for same color positions (as the cell
+  //   being scored)
+  // - opVals: 64-bit mask with bits set for opposite color positions
+  // - empty: 64-bit mask with bits set for empty positions
+  virtual int scoreCell(size_t row, size_t col, size_t pos, Board::Set myVals,
+                        Board::Set opVals, Board::Set empty) const = 0;
 };
 
-class FullScore : public Score {
+class FullScore final : public Score {
 public:
   // The score of a cell will be one of the following values:
   // - Corner: most valuable location since it can't be flipped
@@ -102,11 +113,12 @@ public:
   };
   std::string toString() const override { return "FullScore"; }
 private:
-  int scoreCell(size_t, size_t, size_t, const Board::Set&, const Board::Set&,
-                const Board::Set&) const override;
+  friend class Score; // for calling 'scoreCell' directly
+  int scoreCell(size_t, size_t, size_t, Board::Set, Board::Set,
+                Board::Set) const override;
 };
 
-class WeightedScore : public Score {
+class WeightedScore final : public Score {
 public:
   std::string toString() const override { return "WeightedScore"; }
   // Meanings are similar to FullScore, but since there is no functionality for
@@ -122,8 +134,9 @@ public:
     Corner = 4
   };
 private:
-  int scoreCell(size_t, size_t, size_t, const Board::Set&, const Board::Set&,
-                const Board::Set&) const override;
+  friend class Score; // for calling 'scoreCell' directly
+  int scoreCell(size_t, size_t, size_t, Board::Set, Board::Set,
+                Board::Set) const override;
 };
 
 } // namespace othello
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <othello/MappedFile.h>
+#include <othello/Score.h>
+
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+namespace othello {
+
+// 'SearchCache' keeps root search results across games (and across runs of
+// the program). Results from a previous run are memory mapped from 'file'
+// and looked up using a binary search whereas new results are kept in memory
+// until 'flush' writes all of them back to 'file' (sorted by hash). Results
+// depend on how a player searches so a cache has a 'config' value (based on
+// the 'Score' type, search depth and selectivity) and a file with a different
+// config is ignored (and replaced by 'flush').
+class SearchCache {
+public:
+  // 'moves' has a bit set for each of the best moves (there can be more than
+  // one with the same score), 'score' is from the point of view of the color
+  // to move and 'bound' is a 'TranspositionTable::Bound' value
+  struct Entry {
+    Board::Set hash;
+    Board::Set moves;
+    int32_t score;
+    uint8_t depth;
+    uint8_t bound;
+    uint16_t reserved = 0;
+  };
+  static_assert(sizeof(Entry) == 24);
+
+  struct Header {
+    std::array<char, 8> magic;
+    uint64_t config;
+    uint64_t entries;
+  };
+  static constexpr std::array<char, 8> Magic = {
+    'O', 'T', 'H', 'C', 'A', 'C', 'H', '1'};
+
+  // 'config' returns the config value for a player using 'score', 'depth'
+  // and 'selectivity' (see 'ProbCut')
+  static uint64_t config(const Score& score, size_t depth,
+                         size_t selectivity = 0);
+
+  SearchCache(std::string file, uint64_t config);
+
+  // 'find' returns the entry for 'hash' (if there is one)
+  std::optional<Entry> find(Board::Set hash) const;
+
+  // 'add' adds (or replaces) the entry for 'entry.hash'
+  void add(const Entry& entry) { _added[entry.hash] = entry; }
+
+  // 'flush' writes all entries to 'file' (by writing a new file and renaming
+  // it so the current mapping stays valid) and returns false if it fails
+  bool flush() const;
+
+  auto config() const noexcept { return _config; }
+  auto& file() const noexcept { return _fileName; }
+  // 'size' is the number of entries (loaded plus added) and 'added' is the
+  // number of entries added since the file was loaded
+  size_t size() const;
+  auto added() const noexcept { return _added.size(); }
+private:
+  const std::string _fileName;
+  const uint64_t _config;
+  const MappedFile _file;
+  std::span<const Entry> _entries;
+  std::unordered_map<Board::Set, Entry> _added;
+};
+
+} // namespace othello
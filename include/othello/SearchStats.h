@@ -0,0 +1,55 @@
+#pragma once
+
+#include <othello/Board.h>
+
+#include <chrono>
+
+namespace othello {
+
+// 'SearchStats' holds counts collected during a search. Each search thread
+// keeps its own copy (so counters aren't shared between threads) and copies
+// are merged using '+=' when a thread finishes.
+struct SearchStats {
+  enum Values {
+    CutoffIndexes = 8 // the last entry of 'cutoffs' counts all later moves
+  };
+  using Time = std::chrono::nanoseconds;
+
+  // 'nodes' is the number of positions searched (that have valid moves) and
+  // 'leaves' is the number of positions scored. 'cutoffs' counts beta cutoffs
+  // by the index of the move that caused it (0 is the first move searched).
+  long long nodes = 0;
+  long long leaves = 0;
+  std::array<long long, CutoffIndexes> cutoffs{};
+  long long tableProbes = 0;
+  long long tableHits = 0;
+  long long tableStores = 0;
+  // 'probCuts' is the number of nodes pruned by 'ProbCut' checks
+  long long probCuts = 0;
+
+  // 'depth' is the deepest completed search and 'depthTimes' has the time taken
+  // by each completed depth (starting at depth 1). 'time' is the total time.
+  size_t depth = 0;
+  std::array<Time, Board::Size> depthTimes{};
+  Time time{0};
+
+  void cutoff(size_t index) noexcept {
+    ++cutoffs[std::min<size_t>(index, CutoffIndexes - 1)];
+  }
+
+  // 'nodesPerSecond' counts both 'nodes' and 'leaves' and 'branchingFactor' is
+  // the 'effective branching factor' ('depth' root of 'nodes' plus 'leaves')
+  double nodesPerSecond() const noexcept;
+  double branchingFactor() const noexcept;
+
+  // 'firstMoveCutoffs' is the fraction of cutoffs caused by the first move
+  // (which shows how good move ordering is)
+  double firstMoveCutoffs() const noexcept;
+
+  // counts are added, 'depth' is the max and times are added
+  SearchStats& operator+=(const SearchStats&) noexcept;
+};
+
+std::ostream& operator<<(std::ostream&, const SearchStats&);
+
+} // namespace othello
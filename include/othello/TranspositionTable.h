@@ -0,0 +1,90 @@
+#pragma once
+
+#include <othello/Board.h>
+
+#include <atomic>
+#include <optional>
+
+namespace othello {
+
+// 'TranspositionTable' is a fixed size hash table of search results keyed by
+// 'Board::hash'. It's split into buckets of 'BucketSize' entries (one cache
+// line per bucket) and a position can be stored in any entry of its bucket.
+//
+// The table doesn't use any locks: each entry is two 64-bit atomic words (the
+// data and the key XOR'd with the data) so a reader can detect an entry that
+// was partly overwritten by another thread (the key won't match) and treat it
+// as a miss. This makes it safe to share one table between search threads.
+class TranspositionTable {
+public:
+  enum Values { BucketSize = 4, DefaultMegabytes = 16 };
+
+  // 'Bound' says how 'score' relates to the real value of the position:
+  // 'Exact' is the real value, 'Lower' means the real value is at least
+  // 'score' (search failed high) and 'Upper' means it's at most 'score'
+  // (search failed low)
+  enum class Bound : uint8_t { Exact, Lower, Upper };
+
+  struct Entry {
+    int score;
+    uint8_t depth;
+    Bound bound;
+    uint8_t move; // position of the best move or 'NoMove'
+  };
+  static constexpr uint8_t NoMove = Board::Size;
+
+  // create a table using (at most) 'megabytes' of memory - the number of
+  // buckets is rounded down to a power of 2 and a size of 0 creates an empty
+  // table that never stores anything
+  explicit TranspositionTable(size_t megabytes = DefaultMegabytes);
+  TranspositionTable(const TranspositionTable&) = delete;
+  TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+  // 'probe' returns the entry for 'hash' if it's in the table
+  std::optional<Entry> probe(Board::Set hash) const noexcept;
+
+  // 'store' always stores the new entry (replacing an existing entry for the
+  // same position). Otherwise the entry replaced is the least useful one in
+  // the bucket, i.e., an empty entry, then entries from previous searches and
+  // finally the entry with the lowest depth.
+  void store(Board::Set hash, size_t depth, Bound, int score,
+             size_t move = NoMove) noexcept;
+
+  // 'newSearch' should be called at the start of each search so entries from
+  // older searches are replaced first (they are still returned by 'probe')
+  void newSearch() noexcept { ++_generation; }
+  void clear() noexcept;
+
+  auto size() const noexcept { return _buckets.size() * BucketSize; }
+  auto megabytes() const noexcept {
+    return _buckets.size() * sizeof(Bucket) / (1024 * 1024);
+  }
+private:
+  struct Slot {
+    std::atomic<uint64_t> key; // hash XOR data
+    std::atomic<uint64_t> data;
+  };
+  struct alignas(BucketSize * sizeof(Slot)) Bucket {
+    std::array<Slot, BucketSize> slots;
+  };
+
+  // 'data' packs an entry and the search generation into 64 bits (a value of 0
+  // is an empty entry since 'store' never creates a 0 depth entry)
+  static uint64_t pack(const Entry&, uint8_t generation) noexcept;
+  static Entry unpack(uint64_t data) noexcept;
+  static uint8_t generation(uint64_t data) noexcept {
+    return static_cast<uint8_t>(data >> 56);
+  }
+
+  auto& bucket(Board::Set hash) noexcept {
+    return _buckets[hash & (_buckets.size() - 1)];
+  }
+  auto& bucket(Board::Set hash) const noexcept {
+    return _buckets[hash & (_buckets.size() - 1)];
+  }
+
+  std::vector<Bucket> _buckets;
+  uint8_t _generation = 0;
+};
+
+} // namespace othello
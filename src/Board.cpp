@@ -2,55 +2,234 @@
 
 #include <iomanip>
 
+#if defined(__x86_64__) || defined(__i386__)
+#define OTHELLO_X86
+#include <immintrin.h>
+#endif
+
 namespace othello {
 
 namespace {
 
-enum BoardValues {
-  FirstPos,
-  OneColumn,
-  SecondRowEnd = 15,
-  SeventhRowStart = 48
-};
+enum BoardValues { OneColumn = 1, InnerLineBits = 0x3f, LineBits = 0xff };
 
 inline auto rowSizeCheck(size_t x) { return x < Board::Rows; };
 
-// must be > 2rd row to flip up
-inline auto canFlipUp(size_t x) { return x > SecondRowEnd; };
+// 'OutflankTable' is indexed by the position of a move in a line (a row,
+// column or diagonal) and the opposite color cells in the line. Only the inner
+// 6 cells are used for the index since the end cells can never be flipped. The
+// result has a bit set for the cell just past each run of opposite color cells
+// that starts next to the move, i.e., the cells that must have my color for
+// the run to be flipped.
+constexpr auto OutflankTable = [] {
+  std::array<std::array<uint8_t, InnerLineBits + 1>, Board::Rows> result{};
+  for (auto x = 0; x < Board::Rows; ++x)
+    for (auto inner = 0; inner <= InnerLineBits; ++inner) {
+      const auto op = inner << 1;
+      auto outflank = 0, y = x + 1;
+      while (y < Board::Rows && op >> y & 1) ++y;
+      if (y > x + 1 && y < Board::Rows) outflank |= 1 << y;
+      for (y = x - 1; y >= 0 && op >> y & 1;) --y;
+      if (y < x - 1 && y >= 0) outflank |= 1 << y;
+      result[static_cast<size_t>(x)][static_cast<size_t>(inner)] =
+        static_cast<uint8_t>(outflank);
+    }
+  return result;
+}();
+
+// 'FlipTable' is indexed by the position of a move in a line and the outflank
+// cells (found via 'OutflankTable') and has bits set for all the cells between
+// the move and each outflank cell
+constexpr auto FlipTable = [] {
+  std::array<std::array<uint8_t, LineBits + 1>, Board::Rows> result{};
+  for (auto x = 0; x < Board::Rows; ++x)
+    for (auto outflank = 0; outflank <= LineBits; ++outflank) {
+      auto flips = 0;
+      for (auto y = 0; y < Board::Rows; ++y)
+        if (outflank >> y & 1)
+          for (auto i = std::min(x, y) + 1; i < std::max(x, y); ++i)
+            flips |= 1 << i;
+      result[static_cast<size_t>(x)][static_cast<size_t>(outflank)] =
+        static_cast<uint8_t>(flips);
+    }
+  return result;
+}();
+
+// return the cells to flip in a single line of 8 cells
+inline uint64_t lineFlips(size_t x, uint64_t myLine, uint64_t opLine) {
+  return FlipTable[x][OutflankTable[x][opLine >> 1 & InnerLineBits] & myLine];
+}
 
-// must be < 7th row flip down
-inline auto canFlipDown(size_t x) { return x < SeventhRowStart; };
+// masks for the diagonal (down and right) and anti-diagonal (down and left)
+// lines going through each position
+struct Diagonals {
+  uint64_t diagonal;
+  uint64_t antiDiagonal;
+};
+constexpr auto DiagonalMasks = [] {
+  std::array<Diagonals, Board::Size> result{};
+  for (auto pos = 0; pos < Board::Size; ++pos) {
+    const auto row = pos / Board::Rows, col = pos % Board::Rows;
+    auto& masks = result[static_cast<size_t>(pos)];
+    for (auto r = 0; r < Board::Rows; ++r) {
+      const auto bit = [r](int c) { return 1ULL << (r * Board::Rows + c); };
+      if (const auto c = col + r - row; c >= 0 && c < Board::Rows)
+        masks.diagonal |= bit(c);
+      if (const auto c = col + row - r; c >= 0 && c < Board::Rows)
+        masks.antiDiagonal |= bit(c);
+    }
+  }
+  return result;
+}();
 
-// must be > 2rd column to flip left
-inline auto canFlipLeft(size_t x) { return x % Board::Rows > OneColumn; };
+constexpr uint64_t FirstColumn = 0x0101010101010101ULL;
+// multiplying by 'ColumnToLine' moves the bits of the first column (row 'r' is
+// bit 'r * 8') to the top byte (row 'r' becomes bit '56 + r')
+constexpr uint64_t ColumnToLine = 0x0102040810204080ULL;
+// multiplying by 'LineToColumn' spreads a line back into the first column,
+// this relies on flips never including the end cells (bits 0 and 7) since
+// these are the only bits that can collide and cause a carry
+constexpr uint64_t LineToColumn = 0x0002040810204081ULL;
+constexpr auto LineShift = Board::SizeSubRows;
 
-// must be < 7th column to flip right
-inline auto canFlipRight(size_t x) { return x % Board::Rows < Board::RowSub2; };
+// gather the cells of a diagonal into a line indexed by column (there's only
+// one cell per column so no bits collide when multiplying)
+inline uint64_t diagonalToLine(uint64_t x) {
+  return x * FirstColumn >> LineShift;
+}
 
-constexpr auto TopEdge = [](int x) { return x >= FirstPos; };
-constexpr auto BottomEdge = [](int x) { return x < Board::Size; };
-constexpr auto LeftEdge = [](int x) {
-  return x % Board::Rows != Board::RowSub1;
+// return all the cells flipped by playing at 'pos' - this is done by looking up
+// the flips for the row, column and both diagonals in precomputed tables
+uint64_t portableFlips(size_t pos, uint64_t myVals, uint64_t opVals) {
+  const auto row = pos / Board::Rows, col = pos % Board::Rows;
+  const auto rowShift = row * Board::Rows;
+  // row (line is indexed by column)
+  auto result = lineFlips(col, myVals >> rowShift & LineBits,
+                          opVals >> rowShift & LineBits)
+                << rowShift;
+  // column (line is indexed by row)
+  const auto column = [col](uint64_t x) {
+    return (x >> col & FirstColumn) * ColumnToLine >> LineShift;
+  };
+  result |= ((lineFlips(row, column(myVals), column(opVals)) * LineToColumn) &
+             FirstColumn)
+            << col;
+  // diagonals (lines are indexed by column)
+  for (const auto mask : {DiagonalMasks[pos].diagonal,
+                          DiagonalMasks[pos].antiDiagonal})
+    result |= (lineFlips(col, diagonalToLine(myVals & mask),
+                         diagonalToLine(opVals & mask)) *
+               FirstColumn) &
+              mask;
+  return result;
+}
+
+// 'Lines' has a mask for each of the 4 lines going through a position along
+// with the index of the position within each line (after its cells have been
+// packed together)
+struct Lines {
+  std::array<uint64_t, 4> masks;
+  std::array<uint8_t, 4> indexes;
 };
-constexpr auto RightEdge = [](int x) { return x % Board::Rows != FirstPos; };
-
-constexpr auto UpLeft = [](int x) { return TopEdge(x) && LeftEdge(x); };
-constexpr auto DownLeft = [](int x) { return BottomEdge(x) && LeftEdge(x); };
-constexpr auto UpRight = [](int x) { return TopEdge(x) && RightEdge(x); };
-constexpr auto DownRight = [](int x) { return BottomEdge(x) && RightEdge(x); };
-
-// lambdas used for checking bounds when finding valid moves or performing flips
-constexpr auto UpCheck = std::make_pair(-Board::Rows, TopEdge);
-constexpr auto DownCheck = std::make_pair(Board::Rows, BottomEdge);
-
-// LeftCheck must also check >= 0 to avoid 'mod -1' so use same lambda for both
-// Left and UpLeft cases
-constexpr auto LeftCheck = std::make_pair(-OneColumn, UpLeft);
-constexpr auto UpLeftCheck = std::make_pair(-Board::RowAdd1, UpLeft);
-constexpr auto DownLeftCheck = std::make_pair(Board::RowSub1, DownLeft);
-constexpr auto RightCheck = std::make_pair(OneColumn, RightEdge);
-constexpr auto UpRightCheck = std::make_pair(-Board::RowSub1, UpRight);
-constexpr auto DownRightCheck = std::make_pair(Board::RowAdd1, DownRight);
+constexpr auto LineMasks = [] {
+  std::array<Lines, Board::Size> result{};
+  for (size_t pos = 0; pos < Board::Size; ++pos) {
+    const auto row = pos / Board::Rows, col = pos % Board::Rows;
+    auto& lines = result[pos];
+    lines.masks = {uint64_t{LineBits} << row * Board::Rows, FirstColumn << col,
+                   DiagonalMasks[pos].diagonal,
+                   DiagonalMasks[pos].antiDiagonal};
+    for (size_t i = 0; i < lines.masks.size(); ++i)
+      lines.indexes[i] = static_cast<uint8_t>(
+        std::popcount(lines.masks[i] & ((1ULL << pos) - 1)));
+  }
+  return result;
+}();
+
+#ifdef OTHELLO_X86
+// same as 'portableFlips', but each line is packed using PEXT and the flips
+// are put back on the board using PDEP
+__attribute__((target("bmi2"))) uint64_t bmi2Flips(size_t pos,
+                                                   uint64_t myVals,
+                                                   uint64_t opVals) {
+  uint64_t result = 0;
+  const auto& lines = LineMasks[pos];
+  for (size_t i = 0; i < lines.masks.size(); ++i) {
+    const auto mask = lines.masks[i];
+    result |= _pdep_u64(lineFlips(lines.indexes[i], _pext_u64(myVals, mask),
+                                  _pext_u64(opVals, mask)),
+                        mask);
+  }
+  return result;
+}
+
+#define OTHELLO_AVX2 __attribute__((target("avx2")))
+
+// flood from 'move' over opposite color cells in 4 directions at the same time
+// (one direction per 64-bit lane) and only keep the runs that end with one of
+// my cells - there are no branches that depend on the board contents
+template<bool Left>
+OTHELLO_AVX2 inline __m256i avx2Flood(__m256i move, __m256i my, __m256i op,
+                                      __m256i shifts) {
+  const auto shift = [shifts](__m256i x) OTHELLO_AVX2 {
+    if constexpr (Left)
+      return _mm256_sllv_epi64(x, shifts);
+    else
+      return _mm256_srlv_epi64(x, shifts);
+  };
+  auto result = _mm256_and_si256(op, shift(move));
+  for (auto i = 0; i < Board::RowSub2 - 1; ++i)
+    result = _mm256_or_si256(result, _mm256_and_si256(op, shift(result)));
+  // clear lanes where the cell after the run isn't my color
+  const auto outflank = _mm256_and_si256(my, shift(result));
+  return _mm256_andnot_si256(
+    _mm256_cmpeq_epi64(outflank, _mm256_setzero_si256()), result);
+}
+
+// find flips in all 8 directions using 4 shift amounts (one per lane) shifted
+// both left and right
+OTHELLO_AVX2 uint64_t avx2Flips(size_t pos, uint64_t myVals, uint64_t opVals) {
+  // lanes (from low to high): right, down, down-left and down-right when
+  // shifting left and the opposite directions when shifting right
+  const auto shifts = _mm256_set_epi64x(Board::RowAdd1, Board::RowSub1,
+                                        Board::Rows, OneColumn);
+  constexpr auto notEdge = static_cast<long long>(Board::NotEdgeColumns);
+  const auto op = _mm256_and_si256(
+    _mm256_set1_epi64x(static_cast<long long>(opVals)),
+    _mm256_set_epi64x(notEdge, notEdge, static_cast<long long>(Board::AllCells),
+                      notEdge));
+  const auto my = _mm256_set1_epi64x(static_cast<long long>(myVals));
+  const auto move = _mm256_set1_epi64x(static_cast<long long>(1ULL << pos));
+  const auto flips =
+    _mm256_or_si256(avx2Flood<true>(move, my, op, shifts),
+                    avx2Flood<false>(move, my, op, shifts));
+  const auto result = _mm_or_si128(_mm256_castsi256_si128(flips),
+                                   _mm256_extracti128_si256(flips, 1));
+  return static_cast<uint64_t>(_mm_cvtsi128_si64(result) |
+                               _mm_extract_epi64(result, 1));
+}
+#endif
+
+using FlipFunction = uint64_t (*)(size_t, uint64_t, uint64_t);
+
+FlipFunction flipFunction(Board::FlipKernel kernel) {
+#ifdef OTHELLO_X86
+  if (kernel == Board::FlipKernel::Bmi2) return bmi2Flips;
+  if (kernel == Board::FlipKernel::Avx2) return avx2Flips;
+#endif
+  assert(kernel == Board::FlipKernel::Portable);
+  return portableFlips;
+}
+
+auto bestFlipKernel() {
+  return Board::flipKernelSupported(Board::FlipKernel::Bmi2)
+           ? Board::FlipKernel::Bmi2
+           : Board::FlipKernel::Portable;
+}
+
+// kernel chosen at startup (can be changed by calling 'Board::setFlipKernel')
+auto currentFlipKernel = bestFlipKernel();
+auto currentFlips = flipFunction(currentFlipKernel);
 
 // for printing to stream
 constexpr auto Border = "\
@@ -64,132 +243,110 @@ Board::Board(const std::string& str, size_t initialEmpty) {
   assert(initialEmpty + str.size() <= Size);
   for (auto i = initialEmpty; auto c : str) {
     if (c == BlackCell)
-      _black.set(i);
+      _black |= bit(i);
     else if (c == WhiteCell)
-      _white.set(i);
+      _white |= bit(i);
     ++i;
   }
+  _hash = calculateHash(_black, _white);
 }
 
 std::string Board::toString() const {
   std::string result(Size, EmptyCell);
   for (size_t i = 0; i < Size; ++i)
-    if (_black[i]) {
-      assert(!_white[i]);
+    if (black(i)) {
+      assert(!white(i));
       result[i] = BlackCell;
-    } else if (_white[i])
+    } else if (white(i))
       result[i] = WhiteCell;
   return result;
 }
 
 Board::Moves Board::validMoves(Color c) const {
   Moves result;
-  auto& myVals = c == Color::Black ? _black : _white;
-  auto& opVals = c == Color::Black ? _white : _black;
-  for (size_t i = 0; i < Size; ++i)
-    if (!occupied(i) && validMove(i, myVals, opVals))
-      result.emplace_back(posToString(i));
+  for (auto i : validMoveBits(c)) result.emplace_back(i);
   return result;
 }
 
-size_t Board::validMoves(Color c, Boards& boards, Positions& positions) const {
-  size_t count = 0;
-  Board board(*this);
-  for (size_t i = 0; i < Size; ++i)
-    if (!occupied(i) && board.set(i, c)) {
-      assert(count < MaxValidMoves);
-      boards[count] = board;
-      positions[count++] = i;
-      board = *this;
-    }
-  return count;
+Board::FlipKernel Board::flipKernel() { return currentFlipKernel; }
+
+bool Board::setFlipKernel(FlipKernel kernel) {
+  if (!flipKernelSupported(kernel)) return false;
+  currentFlipKernel = kernel;
+  currentFlips = flipFunction(kernel);
+  return true;
 }
 
-bool Board::hasValidMoves(Color c) const {
-  auto& myVals = c == Color::Black ? _black : _white;
-  auto& opVals = c == Color::Black ? _white : _black;
-  for (size_t i = 0; i < Size; ++i)
-    if (!occupied(i) && validMove(i, myVals, opVals)) return true;
-  return false;
+Board::Set Board::flips(size_t pos, Set my, Set op) {
+  return currentFlips(pos, my, op);
 }
 
-bool Board::validMove(size_t pos, const Set& myVals, const Set& opVals) const {
-  const auto valid = [&](const auto& c) {
-    if (int x = static_cast<int>(pos) + c.first; test(opVals, x)) {
-      x += c.first;
-      do {
-        if (test(myVals, x)) return true;
-        if (!test(opVals, x)) break;
-        x += c.first;
-      } while (c.second(x));
-    }
-    return false;
-  };
-  const auto flipUp = canFlipUp(pos);
-  if (flipUp && valid(UpCheck)) return true;
-  const auto flipDown = canFlipDown(pos);
-  return (flipDown && valid(DownCheck)) ||
-         (canFlipLeft(pos) &&
-          (valid(LeftCheck) || (flipUp && valid(UpLeftCheck)) ||
-           (flipDown && valid(DownLeftCheck)))) ||
-         (canFlipRight(pos) &&
-          (valid(RightCheck) || (flipUp && valid(UpRightCheck)) ||
-           (flipDown && valid(DownRightCheck))));
+bool Board::flipKernelSupported(FlipKernel kernel) {
+  if (kernel == FlipKernel::Portable) return true;
+#ifdef OTHELLO_X86
+  __builtin_cpu_init(); // needed since this is called during static init
+  if (kernel == FlipKernel::Avx2) return __builtin_cpu_supports("avx2");
+  return __builtin_cpu_supports("bmi2");
+#else
+  return false;
+#endif
 }
 
 int Board::set(const std::string& pos, Color c) {
+  const auto x = toPos(pos);
+  if (x < 0) return x;
+  if (occupied(static_cast<size_t>(x))) return BadCell;
+  return set(static_cast<size_t>(x), c);
+}
+
+int Board::toPos(const std::string& pos) {
   if (pos.size() != 2) return BadSize;
   const auto col = static_cast<size_t>(pos[0] - 'a');
   if (!rowSizeCheck(col)) return BadColumn;
   const auto row = static_cast<size_t>(pos[1] - '1');
   if (!rowSizeCheck(row)) return BadRow;
-  const auto x = static_cast<size_t>(row * Rows + col);
-  if (occupied(x)) return BadCell;
-  return set(x, c);
-}
-
-int Board::set(size_t posIn, Set& myVals, Set& opVals) {
-  auto totalFlipped = 0;
-  const auto pos = static_cast<int>(posIn);
-  // bounds are already checked before calling 'flip' so can use do-while
-  const auto flip = [&](const auto& c) {
-    if (auto x = pos + c.first; test(opVals, x)) {
-      x += c.first;
-      do {
-        if (test(myVals, x)) { // found 'op-vals' + 'my-val' so flip backwards
-          for (x -= c.first; x != pos; x -= c.first) {
-            const auto v = static_cast<size_t>(x);
-            assert(!myVals[v]);
-            assert(opVals[v]);
-            ++totalFlipped;
-            myVals.set(v);
-            opVals.reset(v);
-          }
-          break;
-        } else if (!test(opVals, x))
-          break; // found a space in the chain so nothing to flip
-        x += c.first;
-      } while (c.second(x));
-    }
-  };
-  // check 8 directions for flips
-  const auto flipUp = canFlipUp(posIn);
-  if (flipUp) flip(UpCheck);
-  const auto flipDown = canFlipDown(posIn);
-  if (flipDown) flip(DownCheck);
-  if (canFlipLeft(posIn)) {
-    flip(LeftCheck);
-    if (flipUp) flip(UpLeftCheck);
-    if (flipDown) flip(DownLeftCheck);
-  }
-  if (canFlipRight(posIn)) {
-    flip(RightCheck);
-    if (flipUp) flip(UpRightCheck);
-    if (flipDown) flip(DownRightCheck);
+  return static_cast<int>(row * Rows + col);
+}
+
+int Board::set(size_t pos, Color c) {
+  assert(pos < Size && !occupied(pos));
+  const auto black = c == Color::Black;
+  const auto flipped = currentFlips(pos, black ? _black : _white,
+                                    black ? _white : _black);
+  if (!flipped) return 0; // don't set 'pos' if it didn't result in flips
+  play(flipped, pos, c);
+  return std::popcount(flipped);
+}
+
+Board::Undo Board::makeMove(size_t pos, Color c) {
+  assert(pos < Size && !occupied(pos));
+  const auto black = c == Color::Black;
+  const Undo undo{
+    currentFlips(pos, black ? _black : _white, black ? _white : _black), _hash,
+    static_cast<uint8_t>(pos), c};
+  assert(undo.flips);
+  play(undo.flips, pos, c);
+  return undo;
+}
+
+Board Board::transform(Symmetry sym) const {
+  Board result;
+  result._black = transform(_black, sym);
+  result._white = transform(_white, sym);
+  result._hash = calculateHash(result._black, result._white);
+  return result;
+}
+
+std::pair<Board, Board::Symmetry> Board::canonical() const {
+  auto result = std::pair(*this, Symmetry::Identity);
+  for (auto sym : Symmetries) {
+    const auto black = transform(_black, sym);
+    const auto white = transform(_white, sym);
+    const auto& best = result.first;
+    if (black < best._black || (black == best._black && white < best._white))
+      result = {transform(sym), sym};
   }
-  // set 'posIn' cell (passed into this function) if it resulted in flips
-  if (totalFlipped > 0) myVals.set(posIn);
-  return totalFlipped;
+  return result;
 }
 
 Board::GameResults Board::printGameResult(bool tournament) const {
@@ -0,0 +1,176 @@
+#include <othello/Endgame.h>
+
+#include <algorithm>
+
+namespace othello {
+
+namespace {
+
+using Set = Board::Set;
+
+// cells of each 4x4 quadrant of the board
+constexpr std::array<Set, 4> Quadrants = {0x000000000f0f0f0fULL,
+  0x00000000f0f0f0f0ULL, 0x0f0f0f0f00000000ULL, 0xf0f0f0f000000000ULL};
+
+// return the cells of quadrants that have an odd number of 'empties'. Near the
+// end of the game it's usually better to play in these regions since it leaves
+// the other color to move first in the even regions (and get the last move in
+// the odd ones).
+constexpr Set oddQuadrants(Set empties) noexcept {
+  Set result = 0;
+  for (auto i : Quadrants)
+    if (Board::count(empties & i) & 1) result |= i;
+  return result;
+}
+
+} // namespace
+
+int Endgame::solve(const Board& board, Board::Color c, Mode mode) {
+  const auto black = c == Board::Color::Black;
+  const auto my = black ? board.black() : board.white();
+  const auto op = black ? board.white() : board.black();
+  if (mode == Mode::Exact) return solve(my, op, -Inf, Inf);
+  const auto result = solve(my, op, -1, 1);
+  return result > 0 ? 1 : result < 0 ? -1 : 0;
+}
+
+int Endgame::solve(Board::Set my, Board::Set op, int alpha, int beta) {
+  return search(my, op, alpha, beta, false);
+}
+
+int Endgame::search(Set my, Set op, int alpha, int beta, bool passed) {
+  const auto empties = ~(my | op);
+  const auto emptyCount = Board::count(empties);
+  if (emptyCount <= 4) {
+    if (!emptyCount) return discDifference(my, op);
+    if (emptyCount == 1)
+      return solve1(my, op, static_cast<size_t>(std::countr_zero(empties)));
+    // pass the empty cells in parity order
+    const auto odd = oddQuadrants(empties);
+    std::array<size_t, 4> x{};
+    size_t n = 0;
+    for (auto pos : Board::Bits(empties & odd)) x[n++] = pos;
+    for (auto pos : Board::Bits(empties & ~odd)) x[n++] = pos;
+    if (emptyCount == 2) return solve2(my, op, alpha, beta, x[0], x[1], passed);
+    if (emptyCount == 3)
+      return solve3(my, op, alpha, beta, x[0], x[1], x[2], passed);
+    return solve4(my, op, alpha, beta, x[0], x[1], x[2], x[3], passed);
+  }
+  ++_nodes;
+  if (timeUp()) return 0; // result is ignored
+  const auto moves = Board::validMoveBits(my, op);
+  if (moves.empty()) {
+    if (passed) return discDifference(my, op);
+    return -search(op, my, -beta, -alpha, true);
+  }
+  // order moves (insertion sort on 'keys', lowest first)
+  struct Move {
+    size_t pos;
+    Set flips;
+  };
+  std::array<Move, Board::Size> list;
+  std::array<int, Board::Size> keys;
+  size_t n = 0;
+  const auto odd = oddQuadrants(empties);
+  for (auto pos : moves) {
+    const auto flips = Board::flips(pos, my, op);
+    // parity order or else fastest first: fewest replies for the opponent
+    // (using parity to break ties)
+    auto key = Board::test(odd, pos) ? 0 : 1;
+    if (emptyCount > FastestFirstEmpties) {
+      const auto replies =
+        Board::validMoveBits(op ^ flips, my | flips | Board::bit(pos));
+      key += 2 * static_cast<int>(replies.count());
+    }
+    auto i = n++;
+    for (; i > 0 && keys[i - 1] > key; --i) {
+      keys[i] = keys[i - 1];
+      list[i] = list[i - 1];
+    }
+    keys[i] = key;
+    list[i] = {pos, flips};
+  }
+  // principal variation search: null windows for moves after the first
+  int best = -Inf;
+  for (size_t i = 0; i < n; ++i) {
+    const auto [pos, flips] = list[i];
+    const auto childMy = op ^ flips, childOp = my | flips | Board::bit(pos);
+    auto score = -search(childMy, childOp, -(i ? alpha + 1 : beta), -alpha,
+                         false);
+    if (i && score > alpha && score < beta)
+      score = -search(childMy, childOp, -beta, -alpha, false);
+    if (_timeout) return 0;
+    best = std::max(best, score);
+    alpha = std::max(alpha, best);
+    if (alpha >= beta) break;
+  }
+  return best;
+}
+
+int Endgame::solve1(Set my, Set op, size_t x1) {
+  const auto diff = discDifference(my, op);
+  if (const auto flips = Board::flips(x1, my, op))
+    return diff + 2 * static_cast<int>(Board::count(flips)) + 1;
+  // the other color gets the last move if 'my' can't play
+  if (const auto flips = Board::flips(x1, op, my))
+    return diff - 2 * static_cast<int>(Board::count(flips)) - 1;
+  return diff;
+}
+
+int Endgame::solve2(Set my, Set op, int alpha, int beta, size_t x1, size_t x2,
+                    bool passed) {
+  ++_nodes;
+  int best = -Inf;
+  if (const auto flips = Board::flips(x1, my, op)) {
+    best = -solve1(op ^ flips, my | flips | Board::bit(x1), x2);
+    if (best >= beta) return best;
+  }
+  if (const auto flips = Board::flips(x2, my, op))
+    best = std::max(best, -solve1(op ^ flips, my | flips | Board::bit(x2), x1));
+  if (best != -Inf) return best;
+  if (passed) return discDifference(my, op);
+  return -solve2(op, my, -beta, -alpha, x1, x2, true);
+}
+
+int Endgame::solve3(Set my, Set op, int alpha, int beta, size_t x1, size_t x2,
+                    size_t x3, bool passed) {
+  ++_nodes;
+  int best = -Inf;
+  // 'play' tries the move at 'x' (leaving 'a' and 'b') and returns true if
+  // there's a cutoff
+  const auto play = [&](size_t x, size_t a, size_t b) {
+    const auto flips = Board::flips(x, my, op);
+    if (!flips) return false;
+    best = std::max(best, -solve2(op ^ flips, my | flips | Board::bit(x),
+                                  -beta, -std::max(alpha, best), a, b, false));
+    return best >= beta;
+  };
+  if (play(x1, x2, x3) || play(x2, x1, x3) || play(x3, x1, x2)) return best;
+  if (best != -Inf) return best;
+  if (passed) return discDifference(my, op);
+  return -solve3(op, my, -beta, -alpha, x1, x2, x3, true);
+}
+
+int Endgame::solve4(Set my, Set op, int alpha, int beta, size_t x1, size_t x2,
+                    size_t x3, size_t x4, bool passed) {
+  ++_nodes;
+  int best = -Inf;
+  // 'play' tries the move at 'x' (leaving 'a', 'b' and 'c') and returns true
+  // if there's a cutoff
+  const auto play = [&](size_t x, size_t a, size_t b, size_t c) {
+    const auto flips = Board::flips(x, my, op);
+    if (!flips) return false;
+    best = std::max(best, -solve3(op ^ flips, my | flips | Board::bit(x),
+                                  -beta, -std::max(alpha, best), a, b, c,
+                                  false));
+    return best >= beta;
+  };
+  if (play(x1, x2, x3, x4) || play(x2, x1, x3, x4) || play(x3, x1, x2, x4) ||
+      play(x4, x1, x2, x3))
+    return best;
+  if (best != -Inf) return best;
+  if (passed) return discDifference(my, op);
+  return -solve4(op, my, -beta, -alpha, x1, x2, x3, x4, true);
+}
+
+} // namespace othello
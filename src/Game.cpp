@@ -1,13 +1,16 @@
 #include <othello/Game.h>
 
 #include <iomanip>
+#include <sstream>
 
 namespace othello {
 
 void Game::begin() {
   size_t gameCount = 1, blackWins = 0, whiteWins = 0, draws = 0,
          blackPieces = 0, whitePieces = 0;
-  for (auto c : Board::Colors) _players.emplace_back(createPlayer(c));
+  if (_players.empty())
+    for (auto c : Board::Colors) _players.emplace_back(createPlayer(c));
+  if (_matches) std::cout << ">>> Flip kernel: " << Board::flipKernel() << '\n';
   do {
     if (_matches) {
       const auto width = _matches < 10     ? 2
@@ -32,7 +35,12 @@ void Game::begin() {
               << ", White Wins: " << whiteWins << ", Draws: " << draws
               << "\n>>> Black Pieces: " << blackPieces
               << ", White Pieces: " << whitePieces << '\n';
-  for (const auto& p : _players) p->printTotalTime();
+  for (const auto& p : _players) {
+    p->printTotalTime();
+    if (_printStats) p->printStats();
+  }
+  for (const auto& i : _caches)
+    if (!i->flush()) std::cout << "failed to write " << i->file() << '\n';
 }
 
 Board Game::playOneGame() {
@@ -46,13 +54,14 @@ Board Game::playOneGame() {
                   << _players[player ^ 1]->color
                   << " has no valid moves - skipping turn\n";
       auto move = _players[player]->move(board, _matches, lastPlayerMoves);
+      _players[player ^ 1]->opponentMoved();
       lastPlayer = player;
       if (!move) break;
       if (skippedTurns)
         skippedTurns = 0;
       else
         lastPlayerMoves.clear(); // clear when no turns are skipped
-      lastPlayerMoves.emplace_back(*move);
+      lastPlayerMoves.push_back(*move);
     } else
       ++skippedTurns;
   };
@@ -76,6 +85,17 @@ char Game::getChar(Board::Color c, const std::string& msg,
   return line[0];
 }
 
+size_t Game::getNumber(Board::Color c, const std::string& msg, size_t def) {
+  std::string line;
+  do {
+    std::cout << ">>> " << c << " - " << msg << " default '" << def << "': ";
+    std::getline(std::cin, line);
+    if (line.empty()) return def;
+  } while (line.find_first_not_of("0123456789") != std::string::npos ||
+           line.size() > 9);
+  return std::stoul(line);
+}
+
 std::unique_ptr<Player> Game::createPlayer(Board::Color c) {
   static const std::string msg = "player type", choices = "h=human, c=computer";
   static const auto remoteChoices = choices + ", r=remote";
@@ -109,8 +129,19 @@ std::unique_ptr<Player> Game::createPlayer(Board::Color c) {
   else if (type == 'z')
     _matches = 1000;
   const auto search = getChar(
-    c, "search depth", "0=no search, 1-9=moves",
-    [](char x) { return x >= '0' && x <= '9'; }, '3');
+    c, "search depth", "0=no search, 1-9=moves, t=time limit",
+    [](char x) { return x >= '0' && x <= '9' || x == 't'; }, '3');
+  ComputerPlayer::TimeControl timeControl{};
+  if (search == 't') {
+    using Type = ComputerPlayer::TimeControl::Type;
+    const auto perMove = getChar(
+                           c, "time limit", "m=per move, g=per game",
+                           [](char x) { return x == 'm' || x == 'g'; },
+                           'm') == 'm';
+    timeControl.type = perMove ? Type::PerMove : Type::PerGame;
+    timeControl.time = std::chrono::milliseconds(
+      getNumber(c, "milliseconds", perMove ? 1000 : 60000));
+  }
   const auto random = getChar(
     c, "randomized results", "y/n", [](char x) { return x == 'y' || x == 'n'; },
     'y');
@@ -124,8 +155,78 @@ std::unique_ptr<Player> Game::createPlayer(Board::Color c) {
     else
       score = std::make_shared<WeightedScore>();
   }
-  return std::make_unique<ComputerPlayer>(c, search - '0', random == 'y',
-                                          score);
+  // more than one thread is only used for searches deeper than 1
+  const auto threads =
+    search != '0' && search != '1' ? getNumber(c, "search threads", 1) : 1;
+  auto parallel = ComputerPlayer::Parallel::RootSplit;
+  if (threads > 1)
+    switch (getChar(
+      c, "parallel search", "r=root split, l=lazy smp, y=ybwc",
+      [](char x) { return x == 'r' || x == 'l' || x == 'y'; }, 'r')) {
+    case 'l': parallel = ComputerPlayer::Parallel::LazySmp; break;
+    case 'y': parallel = ComputerPlayer::Parallel::Ybwc; break;
+    }
+  // switch to an exact search near the end of the game (0 turns this off)
+  ComputerPlayer::EndgameControl endgame{};
+  if (search != '0') {
+    endgame.empties = getNumber(c, "exact endgame empty cells", 14);
+    if (endgame.empties &&
+        getChar(
+          c, "endgame result", "e=exact, w=win/loss/draw",
+          [](char x) { return x == 'e' || x == 'w'; }, 'e') == 'w')
+      endgame.mode = Endgame::Mode::WinLossDraw;
+  }
+  // pondering searches during the other player's turn
+  const auto ponder =
+    search != '0' &&
+    getChar(
+      c, "ponder on other player's turn", "y/n",
+      [](char x) { return x == 'y' || x == 'n'; }, 'n') == 'y';
+  // use the book written by 'othello_book' (if there is one)
+  static const auto book = std::make_shared<const OpeningBook>("othello.book");
+  const auto useBook =
+    search != '0' && !book->empty() &&
+    getChar(
+      c, "use opening book", "y/n", [](char x) { return x == 'y' || x == 'n'; },
+      'y') == 'y';
+  // selectivity prunes moves that are unlikely to matter (see 'ProbCut')
+  size_t selectivity = 0;
+  if (search != '0' && search != '1')
+    selectivity = static_cast<size_t>(
+      getChar(
+        c, "selectivity", "0=full width, 1-4=more pruning",
+        [](char x) { return x >= '0' && x <= '4'; }, '0') -
+      '0');
+  // a time limit searches as deep as time allows (up to the end of the game)
+  const auto depth =
+    search == 't' ? size_t{Board::Size} : static_cast<size_t>(search - '0');
+  // search results can be cached across games (and runs) using one file for
+  // each config (players with the same config share a cache)
+  std::shared_ptr<SearchCache> cache;
+  if (search != '0' &&
+      getChar(
+        c, "use search cache", "y/n",
+        [](char x) { return x == 'y' || x == 'n'; }, 'n') == 'y') {
+    const auto config = SearchCache::config(*score, depth, selectivity);
+    for (auto& i : _caches)
+      if (i->config() == config) cache = i;
+    if (!cache) {
+      std::stringstream file;
+      file << "othello-" << std::hex << config << ".cache";
+      cache = _caches.emplace_back(
+        std::make_shared<SearchCache>(file.str(), config));
+    }
+  }
+  return std::make_unique<ComputerPlayer>(
+    c, depth, random == 'y', score,
+    ComputerPlayer::Options{.timeControl = timeControl,
+                            .threads = threads,
+                            .parallel = parallel,
+                            .endgame = endgame,
+                            .ponder = ponder,
+                            .book = useBook ? book : nullptr,
+                            .cache = cache,
+                            .selectivity = selectivity});
 }
 
 } // namespace othello
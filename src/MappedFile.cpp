@@ -0,0 +1,29 @@
+#include <othello/MappedFile.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace othello {
+
+MappedFile::MappedFile(const std::string& file) {
+  const auto fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st {};
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    _size = static_cast<size_t>(st.st_size);
+    _data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (_data == MAP_FAILED) {
+      _data = nullptr;
+      _size = 0;
+    }
+  }
+  close(fd); // the mapping stays valid after closing the file
+}
+
+MappedFile::~MappedFile() {
+  if (_data) munmap(_data, _size);
+}
+
+} // namespace othello
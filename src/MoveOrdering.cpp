@@ -0,0 +1,90 @@
+#include <othello/MoveOrdering.h>
+
+#include <limits>
+
+namespace othello {
+
+namespace {
+
+enum Weights {
+  KillerWeight = MoveOrdering::MaxHistory * 4,
+  CellWeight = 64,
+  MobilityWeight = 96
+};
+
+// static value of each cell: corners are best, 'X' cells (diagonally next to
+// a corner) are worst followed by 'C' cells (next to a corner on an edge)
+constexpr std::array Row1 = {8, -3, 2, 1, 1, 2, -3, 8};
+constexpr std::array Row2 = {-3, -6, -1, -1, -1, -1, -6, -3};
+constexpr std::array Row3 = {2, -1, 1, 0, 0, 1, -1, 2};
+constexpr std::array Row4 = {1, -1, 0, 0, 0, 0, -1, 1};
+constexpr std::array CellValues = {Row1, Row2, Row3, Row4,
+                                   Row4, Row3, Row2, Row1};
+
+} // namespace
+
+MoveOrdering::MoveOrdering() noexcept {
+  for (auto& i : _killers) i.fill(NoMove);
+}
+
+Board::Moves MoveOrdering::order(const Board& board, Board::Color c,
+                                 Board::Bits validMoves, size_t ply,
+                                 size_t depth, size_t tableMove) const {
+  Board::Moves result;
+  std::array<int, Board::Size> scores;
+  for (auto pos : validMoves) {
+    const auto s = pos == tableMove ? std::numeric_limits<int>::max()
+                                    : score(board, c, pos, ply, depth);
+    // insertion sort (highest score first) - moves with the same score stay in
+    // position order
+    auto i = result.size();
+    result.emplace_back(pos);
+    for (; i > 0 && scores[i - 1] < s; --i) {
+      scores[i] = scores[i - 1];
+      result[i] = result[i - 1];
+    }
+    scores[i] = s;
+    result[i] = Board::Move(pos);
+  }
+  return result;
+}
+
+void MoveOrdering::cutoff(Board::Color c, size_t ply, size_t pos,
+                          size_t depth) noexcept {
+  if (ply < MaxPly) {
+    auto& killers = _killers[ply];
+    if (killers[0] != pos) {
+      killers[1] = killers[0];
+      killers[0] = static_cast<uint8_t>(pos);
+    }
+  }
+  auto& history = _history[static_cast<size_t>(c)];
+  // halve all values for this color if they get too big (keeps the order)
+  if ((history[pos] += static_cast<int>(depth * depth)) > MaxHistory)
+    for (auto& i : history) i /= 2;
+}
+
+void MoveOrdering::newSearch() noexcept {
+  for (auto& i : _killers) i.fill(NoMove);
+  for (auto& i : _history)
+    for (auto& j : i) j /= 2;
+}
+
+int MoveOrdering::score(const Board& board, Board::Color c, size_t pos,
+                        size_t ply, size_t depth) const {
+  if (ply < MaxPly) {
+    if (_killers[ply][0] == pos) return KillerWeight + 1;
+    if (_killers[ply][1] == pos) return KillerWeight;
+  }
+  auto result = _history[static_cast<size_t>(c)][pos] +
+                CellValues[pos / Board::Rows][pos % Board::Rows] * CellWeight;
+  if (depth >= MobilityDepth) {
+    auto child = board;
+    child.makeMove(pos, c);
+    result -= static_cast<int>(child.validMoveBits(Board::opColor(c)).count()) *
+              MobilityWeight;
+  }
+  return result;
+}
+
+} // namespace othello
@@ -0,0 +1,56 @@
+#include <othello/OpeningBook.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace othello {
+
+OpeningBook::OpeningBook(const std::string& file) : _file(file) {
+  if (_file.size() < sizeof(Header)) return;
+  const auto& header = *reinterpret_cast<const Header*>(_file.data());
+  if (header.magic != Magic ||
+      header.entries > (_file.size() - sizeof(Header)) / sizeof(Entry))
+    return; // leave the book empty
+  _entries = {reinterpret_cast<const Entry*>(_file.data() + sizeof(Header)),
+              static_cast<size_t>(header.entries)};
+}
+
+std::optional<OpeningBook::Entry> OpeningBook::find(
+  Board::Set key) const noexcept {
+  const auto i = std::lower_bound(
+    _entries.begin(), _entries.end(), key,
+    [](const Entry& e, Board::Set k) { return e.hash < k; });
+  if (i == _entries.end() || i->hash != key) return {};
+  return *i;
+}
+
+std::optional<size_t> OpeningBook::move(const Board& board,
+                                        Board::Color c) const {
+  if (empty()) return {};
+  const auto [canonical, sym] = board.canonical();
+  const auto entry = find(canonical.hash(c));
+  if (!entry || entry->move >= Board::Size) return {};
+  const auto pos = Board::transformPos(entry->move, Board::inverse(sym));
+  // make sure the move is valid (in case of a hash collision)
+  if (!Board::test(board.validMoveBits(c).mask(), pos)) return {};
+  return pos;
+}
+
+bool OpeningBook::write(const std::string& file, std::vector<Entry> entries) {
+  std::stable_sort(
+    entries.begin(), entries.end(),
+    [](const Entry& x, const Entry& y) { return x.hash < y.hash; });
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const Entry& x, const Entry& y) {
+                              return x.hash == y.hash;
+                            }),
+                entries.end());
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  const Header header{Magic, entries.size()};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(entries.data()),
+            static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+  return static_cast<bool>(out.flush());
+}
+
+} // namespace othello
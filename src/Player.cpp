@@ -1,9 +1,13 @@
 #include <othello/Player.h>
 #include <othello/Score.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
+#include <mutex>
 #include <random>
 #include <sstream>
+#include <thread>
 
 namespace othello {
 
@@ -62,7 +66,8 @@ Player::Move HumanPlayer::makeMove(Board& board, const Board::Moves&,
       }
     } else {
       flips = board.set(line, color);
-      if (flips > 0) return line;
+      if (flips > 0)
+        return Board::Move(static_cast<size_t>(Board::toPos(line)));
       std::cout << "  invalid move: '" << line << "' - " << errorToString(flips)
                 << "\n  enter location (eg 'a1' or 'h8'), 'q'=quit "
                    ", 'v'=print valid moves\n";
@@ -82,81 +87,665 @@ std::string ComputerPlayer::toString() const {
   std::locale loc("en_US.UTF-8");
   ss.imbue(loc);
 #endif
-  ss << " search=" << _search << " (score called " << _totalScoreCalls << ")";
+  using Type = TimeControl::Type;
+  if (_timeControl.type != Type::None && _search)
+    ss << " time=" << _timeControl.time.count() << "ms per "
+       << (_timeControl.type == Type::PerMove ? "move" : "game");
+  else
+    ss << " search=" << _search;
+  if (_workers.size() > 1)
+    ss << " threads=" << _workers.size()
+       << (_parallel == Parallel::LazySmp ? " (lazy smp)"
+           : _parallel == Parallel::Ybwc  ? " (ybwc)"
+                                          : "");
+  if (_ponder) ss << " ponder";
+  if (_book) ss << " book=" << _book->size();
+  if (_cache) ss << " cache=" << _cache->size();
+  if (_probCut.selectivity())
+    ss << " selectivity=" << _probCut.selectivity();
+  if (_endgame.empties)
+    ss << " endgame=" << _endgame.empties
+       << (_endgame.mode == Endgame::Mode::WinLossDraw ? " (wld)" : "");
+  const auto stats = totalStats();
+  ss << " (score called " << stats.leaves << ", nodes " << stats.nodes << ")";
   return ss.str();
 }
 
+void ComputerPlayer::printStats() const {
+  std::cout << "Search stats for " << color << ": " << totalStats() << '\n';
+}
+
+SearchStats ComputerPlayer::lastMoveStats() const {
+  const std::lock_guard lock(_statsMutex);
+  return _lastMoveStats;
+}
+
+SearchStats ComputerPlayer::totalStats() const {
+  const std::lock_guard lock(_statsMutex);
+  auto result = _totalStats;
+  // include searching done while pondering (that hasn't been added yet)
+  return result += _moveStats;
+}
+
+void ComputerPlayer::gameOver(const Board&, const Board::Moves&) const {
+  stopPondering();
+  _ponderBoards.clear();
+  _gameTime = std::chrono::nanoseconds(0);
+}
+
 Player::Move ComputerPlayer::makeMove(Board& board, const Board::Moves&,
                                       int& flips) const {
   static std::random_device rd;
   static std::mt19937 gen(rd());
 
-  const auto moves = _search == 0 ? board.validMoves(color) : findMoves(board);
+  const auto start = std::chrono::steady_clock::now();
+  stopPondering();
+  const auto ponderHit =
+    std::find(_ponderBoards.begin(), _ponderBoards.end(), board) !=
+    _ponderBoards.end();
+  if (ponderHit) ++_ponderHits;
+  _ponderBoards.clear();
+  {
+    // stats from pondering go in the totals (but not in the move's stats)
+    const std::lock_guard lock(_statsMutex);
+    _totalStats += _moveStats;
+    _moveStats = {};
+  }
+  const auto bookMove = _book ? _book->move(board, color) : std::nullopt;
+  if (bookMove) ++_bookMoves;
+  const auto moves = bookMove      ? Board::Moves{Board::Move(*bookMove)}
+                     : _search == 0 ? board.validMoves(color)
+                                    : findMoves(board, ponderHit);
   assert(!moves.empty());
+  {
+    const std::lock_guard lock(_statsMutex);
+    _moveStats.time = std::chrono::steady_clock::now() - start;
+    _totalStats += _moveStats;
+    _lastMoveStats = _moveStats;
+    _moveStats = {};
+  }
   size_t move = 0;
   if (_random && moves.size() > 1) {
     std::uniform_int_distribution<size_t> dis(0, moves.size() - 1);
     move = dis(gen);
   }
   flips = board.set(moves[move], color);
+  _gameTime += std::chrono::steady_clock::now() - start;
+  if (_ponder && _search) ponder(board);
   return moves[move];
 }
 
-Board::Moves ComputerPlayer::findMoves(const Board& board) const {
-  Board::Boards boards;
-  Board::Positions positions;
-  const auto moves = board.validMoves(color, boards, positions);
-  const auto nextLevel = _search - 1;
-  // return more than one position if moves have the same score
+std::pair<size_t, int> ComputerPlayer::analyze(const Board& board) const {
+  // the ponder thread uses the same worker, table and root score
+  stopPondering();
+  const auto moves = findMoves(board);
+  assert(!moves.empty());
+  // moves are returned in position order
+  return {moves.front().pos(), _rootScore};
+}
+
+void ComputerPlayer::ponder(const Board& board) const {
+  const auto empty = Board::Size - board.blackCount() - board.whiteCount();
+  // nothing to do if the other color can't move or if the next search will be
+  // done by the endgame solver
+  const auto replies = board.validMoveBits(opColor);
+  if (replies.empty() || empty <= _endgame.empties + 1) return;
+  if (const auto entry = _table.probe(board.hash(opColor));
+      entry && entry->move < Board::Size &&
+      Board::test(replies.mask(), entry->move)) {
+    auto child = board;
+    child.makeMove(entry->move, opColor);
+    _ponderBoards.push_back(child);
+  } else
+    for (const auto& i : board.children(opColor))
+      _ponderBoards.push_back(i.board);
+  std::erase_if(_ponderBoards,
+                [this](const Board& b) { return !b.hasValidMoves(color); });
+  if (_ponderBoards.empty()) return;
+  _table.newSearch();
+  for (auto& i : _workers) i.ordering.newSearch();
+  // search all positions at each depth (up to the normal search depth) until
+  // 'stopPondering' is called
+  const auto maxDepth = std::min(_search, empty - 1);
+  _stopHelpers = false;
+  // pondering has no deadline (a timed search that ran out of time leaves
+  // '_timeout' set until the next timed search starts)
+  _timeout = false;
+  _ponderThread = std::thread([this, maxDepth] {
+    auto& w = _workers.front();
+    for (size_t depth = 1; depth <= maxDepth && !_stopPonder; ++depth)
+      for (const auto& b : _ponderBoards)
+        if (!_stopPonder) findMoves(w, b, depth);
+  });
+}
+
+void ComputerPlayer::stopPondering() const {
+  if (!_ponderThread.joinable()) return;
+  _stopPonder = true;
+  _ponderThread.join();
+  _stopPonder = false;
+}
+
+Board::Moves ComputerPlayer::findMoves(const Board& board,
+                                       bool ponderHit) const {
+  // pondering already started a new search for this position
+  if (!ponderHit) {
+    _table.newSearch();
+    for (auto& i : _workers) i.ordering.newSearch();
+  }
+  const auto empty = Board::Size - board.blackCount() - board.whiteCount();
+  const auto maxDepth = std::min(_search, empty);
+  const auto start = std::chrono::steady_clock::now();
+  const auto time = moveTime(board);
+  auto& main = _workers.front();
+  if (_timeControl.type != TimeControl::Type::None) {
+    _deadline = start + time;
+    _timeout = false;
+  }
+  // solve the rest of the game exactly once there are few enough empty cells
+  // (if the solver runs out of time then the normal search still returns at
+  // least a depth 1 result)
+  if (empty <= _endgame.empties)
+    if (auto results = endgameMoves(board); !results.empty()) {
+      _deadline.reset();
+      return results;
+    }
+  // use a result from the cache if it was searched deep enough (timed searches
+  // only use results that were searched to the end of the game)
+  const auto hash = board.hash(color);
+  if (const auto entry = _cache ? _cache->find(hash) : std::nullopt;
+      entry && entry->depth >= maxDepth)
+    if (const auto moves = entry->moves & board.validMoveBits(color).mask()) {
+      ++_cacheHits;
+      _rootScore = entry->score;
+      _deadline.reset();
+      Board::Moves results;
+      const Board::Bits bits(moves);
+      results.assign(bits.begin(), bits.end());
+      return results;
+    }
+  // Lazy SMP helpers keep searching deeper until the main search is done. Odd
+  // helpers start one level deeper so helpers aren't all at the same depth.
+  // YBWC helpers steal tasks until the main search is done
+  std::vector<std::thread> helpers;
+  _stopHelpers = false;
+  if (_parallel == Parallel::LazySmp)
+    for (size_t i = 1; i < _workers.size(); ++i)
+      helpers.emplace_back([&, i] {
+        auto& w = _workers[i];
+        for (auto depth = 1 + i % 2; depth <= maxDepth && !stopped(w); ++depth)
+          findMoves(w, board, depth);
+        addTotals(w);
+      });
+  else if (_parallel == Parallel::Ybwc)
+    for (size_t i = 1; i < _workers.size(); ++i)
+      helpers.emplace_back([&, i] {
+        auto& w = _workers[i];
+        while (!_stopHelpers)
+          if (const auto task = stealTask(w, nullptr))
+            runTask(w, *task);
+          else
+            std::this_thread::yield();
+        addTotals(w);
+      });
+  Board::Moves results;
+  size_t completed = 0;
+  // 'searchDepth' records the depth and time of each completed search
+  const auto searchDepth = [&](size_t depth) {
+    const auto depthStart = std::chrono::steady_clock::now();
+    auto moves = findMoves(main, board, depth);
+    if (!_timeout) {
+      completed = depth;
+      const std::lock_guard lock(_statsMutex);
+      _moveStats.depth = depth;
+      if (depth <= Board::Size)
+        _moveStats.depthTimes[depth - 1] =
+          std::chrono::steady_clock::now() - depthStart;
+    }
+    return moves;
+  };
+  if (_timeControl.type == TimeControl::Type::None)
+    results = searchDepth(_search);
+  else
+    // search one level deeper each time until the deadline passes (a search
+    // that didn't finish is discarded) or until the end of the game is
+    // reached. Depth 1 only calls 'score' for each move so it always finishes.
+    for (size_t depth = 1; depth <= maxDepth; ++depth) {
+      auto moves = searchDepth(depth);
+      if (_timeout) break;
+      results = moves;
+      // don't start another search if it's not likely to finish in time (each
+      // level usually takes several times longer than the previous one)
+      if (std::chrono::steady_clock::now() - start > time / 2) break;
+    }
+  _stopHelpers = true;
+  for (auto& i : helpers) i.join();
+  _deadline.reset();
+  if (_cache && completed) {
+    Board::Set moves = 0;
+    for (auto i : results) moves |= Board::bit(i.pos());
+    _cache->add({hash, moves, _rootScore, static_cast<uint8_t>(completed),
+                 static_cast<uint8_t>(TranspositionTable::Bound::Exact)});
+  }
+  return results;
+}
+
+template<typename S>
+Board::Moves ComputerPlayer::findMoves(Worker& worker, const Board& board,
+                                       size_t depth) const {
+  const auto validMoves = board.validMoveBits(color);
+  const auto moves = validMoves.count();
+  const auto nextLevel = depth - 1;
+  const auto hash = board.hash(color);
+  const auto entry = _table.probe(hash);
+  ++worker.stats.tableProbes;
+  if (entry) ++worker.stats.tableHits;
+  const auto index = static_cast<size_t>(&worker - _workers.data());
+  worker.rootDepth = depth;
+  Moves positions;
+  if (_moveOrdering)
+    positions = worker.ordering.order(
+      board, color, validMoves, 0, depth,
+      entry ? entry->move : MoveOrdering::NoMove);
+  else
+    positions.assign(validMoves.begin(), validMoves.end());
+  // Lazy SMP helpers start with different root moves
+  std::rotate(positions.begin(),
+              positions.begin() +
+                static_cast<std::ptrdiff_t>(index % positions.size()),
+              positions.end());
+  const auto search = [&](Worker& w, size_t pos, int alpha, int beta) {
+    auto child = board;
+    child.makeMove(pos, color);
+    return -callNegamax<S>(w, child, nextLevel, opColor, moves, -beta,
+                           -alpha);
+  };
+  // return more than one position if moves have the same score. The first move
+  // is searched with an 'aspiration window' around the score from a previous
+  // search (if there is one) and the window is opened up if the score falls
+  // outside of it. Scores at depth 1 are always exact so windows aren't used.
   Moves bestMoves;
   int best = Min;
-  for (size_t i = 0; i < moves; ++i)
-    updateMoves(callMinMax(boards[i], nextLevel, opColor, moves, best, Max), i,
-                best, bestMoves);
+  if (!nextLevel)
+    best = search(worker, positions[0].pos(), Min, Max);
+  else {
+    int alpha = Min, beta = Max;
+    if (entry) {
+      alpha = std::max<int>(entry->score - AspirationWindow, Min);
+      beta = std::min<int>(entry->score + AspirationWindow, Max);
+    }
+    do {
+      best = search(worker, positions[0].pos(), alpha, beta);
+      if (best <= alpha && alpha > Min)
+        alpha = Min;
+      else if (best >= beta && beta < Max)
+        beta = Max;
+      else
+        break;
+    } while (!stopped(worker));
+  }
+  bestMoves.push_back(positions[0]);
+  // other moves are searched with a null window to check if they could be at
+  // least as good as 'best' and if so they are searched again with alpha just
+  // below 'best' so a move with the same score gets its exact score (instead
+  // of a bound that could also equal 'best'). Threads take the next unsearched
+  // move until there are none left and share 'best' so a move is never
+  // searched with a lower bound than the best score known when it starts.
+  std::mutex mutex;
+  std::atomic<size_t> next = 1;
+  const auto searchMoves = [&](Worker& w) {
+    for (auto i = next++; i < positions.size() && !stopped(w); i = next++) {
+      const auto pos = positions[i].pos();
+      int score = Min;
+      if (!nextLevel)
+        score = search(w, pos, Min, Max);
+      else {
+        const auto bound = [&] {
+          const std::lock_guard lock(mutex);
+          return best;
+        }();
+        if (score = search(w, pos, bound - 1, bound); score >= bound)
+          score = search(w, pos, bound - 1, Max);
+      }
+      if (stopped(w)) return;
+      const std::lock_guard lock(mutex);
+      updateMoves(score, pos, best, bestMoves);
+    }
+  };
+  std::vector<std::thread> threads;
+  if (_parallel == Parallel::RootSplit && depth >= SplitDepth)
+    for (size_t i = 1; i < std::min(_workers.size(), positions.size() - 1);
+         ++i)
+      threads.emplace_back([&, i] {
+        _workers[i].rootDepth = depth;
+        searchMoves(_workers[i]);
+        addTotals(_workers[i]);
+      });
+  searchMoves(worker);
+  for (auto& i : threads) i.join();
+  if (stopped(worker)) {
+    addTotals(worker);
+    return {};
+  }
+  // keep moves in position order (so the order doesn't depend on the search)
+  std::sort(bestMoves.begin(), bestMoves.end());
+  _table.store(hash, depth, TranspositionTable::Bound::Exact, best,
+               bestMoves.front().pos());
+  ++worker.stats.tableStores;
+  if (&worker == &_workers.front()) _rootScore = best;
   // if there are multiple moves with the same score then only return ones with
   // the best 'first move' score
   if (bestMoves.size() > 1) {
     best = Min;
     Moves newBestMoves;
-    for (auto i : bestMoves)
-      updateMoves(callScore(boards[i]), i, best, newBestMoves);
+    for (const auto& [pos, child] : board.children(color, bestMoves))
+      updateMoves(callScore<S>(worker, child), pos, best, newBestMoves);
     bestMoves = newBestMoves;
   }
-  Board::Moves results;
-  for (auto i : bestMoves)
-    results.emplace_back(Board::posToString(positions[i]));
-  return results;
+  addTotals(worker);
+  return bestMoves;
+}
+
+Board::Moves ComputerPlayer::endgameMoves(const Board& board) const {
+  Endgame endgame(_deadline);
+  const auto exact = _endgame.mode == Endgame::Mode::Exact;
+  const auto black = color == Board::Color::Black;
+  const auto my = black ? board.black() : board.white();
+  const auto op = black ? board.white() : board.black();
+  Moves bestMoves;
+  int best = -Endgame::Inf;
+  for (auto pos : board.validMoveBits(color)) {
+    const auto flips = Board::flips(pos, my, op);
+    // search with alpha just below 'best' so moves with the same result get
+    // exact scores. 'WinLossDraw' only uses windows around 0 and reduces scores
+    // to -1, 0 or 1.
+    const auto alpha = exact ? best - 1 : best > 0 ? 0 : -1;
+    const auto beta = exact ? Endgame::Inf : 1;
+    auto score =
+      -endgame.solve(op ^ flips, my | flips | Board::bit(pos), -beta, -alpha);
+    if (endgame.timedOut()) break;
+    if (!exact) score = std::clamp(score, -1, 1);
+    updateMoves(score, pos, best, bestMoves);
+  }
+  _rootScore = best;
+  {
+    const std::lock_guard lock(_statsMutex);
+    _moveStats.nodes += endgame.nodes();
+    if (!endgame.timedOut())
+      _moveStats.depth = Board::Size - board.blackCount() - board.whiteCount();
+  }
+  if (endgame.timedOut()) return {};
+  return bestMoves;
+}
+
+std::chrono::nanoseconds ComputerPlayer::moveTime(const Board& board) const {
+  if (_timeControl.type == TimeControl::Type::PerMove)
+    return _timeControl.time;
+  // assume this player will make about half of the remaining moves
+  const auto empty = Board::Size - board.blackCount() - board.whiteCount();
+  const auto movesLeft = static_cast<long>(std::max<size_t>(empty / 2, 1));
+  const auto remaining =
+    std::max(_timeControl.time - _gameTime, std::chrono::nanoseconds(0));
+  return remaining / movesLeft;
 }
 
-int ComputerPlayer::minMax(const Board& board, size_t depth, Board::Color turn,
-                           size_t prevMoves, int alpha, int beta) const {
-  Board::Boards boards;
-  const auto moves = board.validMoves(turn, boards);
+template<typename S>
+int ComputerPlayer::negamax(Worker& w, Board& board, size_t depth,
+                            Board::Color turn, size_t prevMoves, int alpha,
+                            int beta) const {
+  using Bound = TranspositionTable::Bound;
+  const auto validMoves = board.validMoveBits(turn);
+  const auto moves = validMoves.count();
   const auto nextLevel = depth - 1;
+  const auto nextTurn = Board::opColor(turn);
   // if no valid moves for current player then go to next level unless there
   // were no valid moves for previous level - in this case stop traversing and
   // return score (by setting depth to 0)
   if (moves == 0)
-    return callMinMax(board, prevMoves ? nextLevel : 0, Board::opColor(turn), 0,
-                      alpha, beta);
-  // maximizing player
-  if (turn == color) {
-    int best = Min;
-    for (size_t i = 0; i < moves && best < beta;
-         ++i, alpha = std::max(alpha, best))
-      best = std::max(
-        best, callMinMax(boards[i], nextLevel, opColor, moves, alpha, beta));
-    return best;
-  }
-  // minimizing player
-  int best = Max;
-  for (size_t i = 0; i < moves && best > alpha;
-       ++i, beta = std::min(beta, best))
-    best = std::min(
-      best, callMinMax(boards[i], nextLevel, color, moves, alpha, beta));
+    return -callNegamax<S>(w, board, prevMoves ? nextLevel : 0, nextTurn, 0,
+                           -beta, -alpha);
+  ++w.stats.nodes;
+  if (timeUp(w)) return 0; // result is ignored
+  const auto hash = board.hash(turn);
+  size_t tableMove = TranspositionTable::NoMove;
+  ++w.stats.tableProbes;
+  if (const auto entry = _table.probe(hash)) {
+    ++w.stats.tableHits;
+    if (entry->depth >= depth &&
+        (entry->bound == Bound::Exact ||
+         entry->bound == Bound::Lower && entry->score >= beta ||
+         entry->bound == Bound::Upper && entry->score <= alpha))
+      return entry->score;
+    // the stored move is checked since a different position could have
+    // overwritten the entry
+    if (entry->move < Board::Size &&
+        Board::test(validMoves.mask(), entry->move))
+      tableMove = entry->move;
+  }
+  // only null window nodes are pruned (so the principal variation is always
+  // searched to the full depth)
+  if (_probCut.enabled() && beta - alpha == 1)
+    if (const auto cut =
+          probCut<S>(w, board, depth, turn, prevMoves, alpha, beta))
+      return *cut;
+  // 'search' makes the move at 'pos', returns the score of the resulting
+  // position for the window (a, b) and then restores 'board'
+  const auto search = [&](size_t pos, int a, int b) {
+    const auto undo = board.makeMove(pos, turn);
+    const auto result =
+      -callNegamax<S>(w, board, nextLevel, nextTurn, moves, -b, -a);
+    board.unmakeMove(undo);
+    return result;
+  };
+  const auto initialAlpha = alpha;
+  size_t bestMove = TranspositionTable::NoMove;
+  int best = Min;
+  // with YBWC, moves after the first are collected and searched by 'split'
+  const auto canSplit = _parallel == Parallel::Ybwc && _workers.size() > 1 &&
+                        depth >= MinSplitDepth;
+  Moves brothers;
+  size_t index = 0; // index of the move being searched (for stats)
+  // 'update' searches 'pos' and returns false if the search should stop. The
+  // first move is searched with the full window and the rest with a null
+  // window (which is much cheaper) since if the moves are well ordered they
+  // are expected to fail low. A move that beats alpha is searched again with
+  // the full window to get its real score. Null windows aren't used for the
+  // last level since scoring a position always gives its real score.
+  const auto update = [&](size_t pos) {
+    const auto i = index++;
+    if (canSplit && bestMove != TranspositionTable::NoMove) {
+      brothers.emplace_back(pos);
+      return true;
+    }
+    const auto first = bestMove == TranspositionTable::NoMove || !nextLevel;
+    auto score = search(pos, alpha, first ? beta : alpha + 1);
+    if (!first && score > alpha && score < beta && !stopped(w))
+      score = search(pos, alpha, beta);
+    if (stopped(w)) return false;
+    if (score > best) {
+      best = score;
+      bestMove = pos;
+    }
+    alpha = std::max(alpha, best);
+    if (alpha < beta) return true;
+    w.ordering.cutoff(turn, w.rootDepth - depth, pos, depth);
+    w.stats.cutoff(i);
+    return false;
+  };
+  // search moves in order (see 'MoveOrdering') or else the move from the table
+  // first and then the rest of the valid moves
+  if (_moveOrdering) {
+    for (auto move : w.ordering.order(board, turn, validMoves,
+                                      w.rootDepth - depth, depth, tableMove))
+      if (!update(move.pos())) break;
+  } else if (tableMove == TranspositionTable::NoMove || update(tableMove))
+    for (auto pos : validMoves)
+      if (pos != tableMove && !update(pos)) break;
+  if (!brothers.empty() && !stopped(w))
+    split<S>(w, board, turn, depth, moves, alpha, beta, best, bestMove,
+             brothers);
+  // don't store results from a search that ran out of time
+  if (stopped(w)) return best;
+  _table.store(hash, depth,
+               best <= initialAlpha ? Bound::Upper
+               : best >= beta       ? Bound::Lower
+                                    : Bound::Exact,
+               best, bestMove);
+  ++w.stats.tableStores;
   return best;
 }
 
+template<typename S>
+std::optional<int> ComputerPlayer::probCut(Worker& w, Board& board,
+                                           size_t depth, Board::Color turn,
+                                           size_t prevMoves, int alpha,
+                                           int beta) const {
+  const auto t = _probCut.threshold();
+  const auto rootDepth = w.rootDepth;
+  std::optional<int> result;
+  for (const auto& i : _probCut.checks(ProbCut::stage(board), depth)) {
+    if (i.a <= 0) continue;
+    // shift the root depth so move ordering uses the same ply as the node
+    w.rootDepth = rootDepth - (depth - i.shallow);
+    // 'high' is the lowest shallow score that predicts a deep score of at
+    // least 'beta' (with the threshold) and 'low' is the highest one that
+    // predicts at most 'alpha' (a check is skipped if its bound can't happen)
+    const auto high = std::ceil((beta + t * i.sigma - i.b) / i.a),
+               low = std::floor((alpha - t * i.sigma - i.b) / i.a);
+    if (high > static_cast<double>(Min + 1) &&
+        high < static_cast<double>(Max)) {
+      const auto bound = static_cast<int>(high);
+      if (negamax<S>(w, board, i.shallow, turn, prevMoves, bound - 1,
+                     bound) >= bound)
+        result = beta;
+    }
+    if (!result && !stopped(w) && low > static_cast<double>(Min) &&
+        low < static_cast<double>(Max - 1)) {
+      const auto bound = static_cast<int>(low);
+      if (negamax<S>(w, board, i.shallow, turn, prevMoves, bound,
+                     bound + 1) <= bound)
+        result = alpha;
+    }
+    if (result || stopped(w)) break;
+  }
+  w.rootDepth = rootDepth;
+  if (result && !stopped(w)) {
+    ++w.stats.probCuts;
+    return result;
+  }
+  return {};
+}
+
+template<typename S>
+void ComputerPlayer::split(Worker& w, const Board& board, Board::Color turn,
+                           size_t depth, size_t moves, int& alpha, int beta,
+                           int& best, size_t& bestMove,
+                           const Moves& brothers) const {
+  SplitPoint sp{w.splitPoint, board, turn, depth, moves, w.rootDepth, beta,
+                alpha, best, bestMove, brothers.size()};
+  {
+    // add in reverse order since this thread takes tasks from the back (the
+    // first move of the node was already searched so brothers start at 1)
+    const std::lock_guard lock(w.mutex);
+    for (auto i = brothers.size(); i > 0; --i)
+      w.tasks.push_back({&sp, brothers[i - 1].pos(), i});
+  }
+  while (const auto task = popTask(w, &sp)) runTask<S>(w, *task);
+  // wait for tasks taken by other threads to finish - only tasks below 'sp'
+  // are stolen while waiting so this thread is free as soon as they are done
+  while (sp.pending)
+    if (const auto task = stealTask(w, &sp))
+      runTask<S>(w, *task);
+    else
+      std::this_thread::yield();
+  const std::lock_guard lock(sp.mutex);
+  alpha = sp.alpha;
+  best = sp.best;
+  bestMove = sp.bestMove;
+}
+
+template<typename S>
+void ComputerPlayer::runTask(Worker& w, const Task& task) const {
+  auto& sp = *task.splitPoint;
+  const auto splitPoint = w.splitPoint;
+  const auto rootDepth = w.rootDepth;
+  w.splitPoint = &sp;
+  w.rootDepth = sp.rootDepth;
+  if (!stopped(w)) {
+    const auto alpha = [&] {
+      const std::lock_guard lock(sp.mutex);
+      return sp.alpha;
+    }();
+    auto child = sp.board;
+    child.makeMove(task.pos, sp.turn);
+    const auto search = [&](int a, int b) {
+      return -callNegamax<S>(w, child, sp.depth - 1,
+                             Board::opColor(sp.turn), sp.moves, -b, -a);
+    };
+    auto score = search(alpha, alpha + 1);
+    if (score > alpha && score < sp.beta && !stopped(w))
+      score = search(alpha, sp.beta);
+    if (!stopped(w)) {
+      const std::lock_guard lock(sp.mutex);
+      if (score > sp.best) {
+        sp.best = score;
+        sp.bestMove = task.pos;
+      }
+      sp.alpha = std::max(sp.alpha, sp.best);
+      if (sp.alpha >= sp.beta) {
+        sp.cutoff = true;
+        w.ordering.cutoff(sp.turn, sp.rootDepth - sp.depth, task.pos,
+                          sp.depth);
+        w.stats.cutoff(task.index);
+      }
+    }
+  }
+  w.splitPoint = splitPoint;
+  w.rootDepth = rootDepth;
+  --sp.pending; // 'sp' can go away after this
+}
+
+const ComputerPlayer::Search& ComputerPlayer::searchFor(const Score* score) {
+  static constexpr Search Dynamic{&ComputerPlayer::findMoves<Score>,
+                                  &ComputerPlayer::runTask<Score>},
+    Full{&ComputerPlayer::findMoves<FullScore>,
+         &ComputerPlayer::runTask<FullScore>},
+    Weighted{&ComputerPlayer::findMoves<WeightedScore>,
+             &ComputerPlayer::runTask<WeightedScore>};
+  // 'FullScore' and 'WeightedScore' are final so there can't be a derived type
+  if (dynamic_cast<const FullScore*>(score)) return Full;
+  if (dynamic_cast<const WeightedScore*>(score)) return Weighted;
+  return Dynamic;
+}
+
+std::optional<ComputerPlayer::Task> ComputerPlayer::popTask(
+  Worker& w, const SplitPoint* splitPoint) {
+  const std::lock_guard lock(w.mutex);
+  if (w.tasks.empty() || w.tasks.back().splitPoint != splitPoint) return {};
+  const auto task = w.tasks.back();
+  w.tasks.pop_back();
+  return task;
+}
+
+std::optional<ComputerPlayer::Task> ComputerPlayer::stealTask(
+  const Worker& w, const SplitPoint* splitPoint) const {
+  const auto below = [splitPoint](const SplitPoint* i) {
+    for (; i; i = i->parent)
+      if (i == splitPoint) return true;
+    return false;
+  };
+  for (auto& i : _workers) {
+    if (&i == &w) continue;
+    const std::lock_guard lock(i.mutex);
+    if (i.tasks.empty() || splitPoint && !below(i.tasks.front().splitPoint))
+      continue;
+    const auto task = i.tasks.front();
+    i.tasks.pop_front();
+    return task;
+  }
+  return {};
+}
+
 RemotePlayer::RemotePlayer(Board::Color c, bool debug)
     : Player(c), _debug(debug),
       _acceptor(_service, tcp::endpoint(tcp::v4(), Port)), _socket(_service),
@@ -207,7 +796,7 @@ Player::Move RemotePlayer::makeMove(Board& board, const Board::Moves& prevMoves,
       if (flips > 0) {
         send(std::to_string(flips));
         send(board);
-        return line;
+        return Board::Move(static_cast<size_t>(Board::toPos(line)));
       }
       send(errorToString(flips));
     }
@@ -0,0 +1,146 @@
+#include <othello/ProbCut.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace othello {
+
+namespace {
+
+// 'Calibrations' has the checks for each 'Score' type (by 'toString') - these
+// were printed by running 'othello_probcut' (with default args)
+const std::map<std::string, std::vector<ProbCut::Check>> Calibrations = {
+  // FullScore: 800 positions, samples by stage: 199 230 199 68
+  {"FullScore",
+   {{0, 3, 1, 1.003, 0.0, 2.4},
+    {0, 4, 2, 1.081, -0.3, 2.7},
+    {0, 5, 3, 1.089, -0.2, 2.4},
+    {0, 6, 4, 1.082, -0.3, 2.0},
+    {0, 7, 3, 1.160, -0.8, 3.2},
+    {0, 8, 4, 1.148, -0.4, 2.4},
+    {0, 9, 5, 1.165, -0.9, 2.6},
+    {0, 10, 6, 1.132, -0.1, 1.9},
+    {1, 3, 1, 1.124, -0.8, 8.3},
+    {1, 4, 2, 1.125, 0.5, 9.2},
+    {1, 5, 3, 1.152, -1.6, 8.0},
+    {1, 6, 4, 1.146, 0.6, 7.0},
+    {1, 7, 3, 1.316, -2.5, 11.8},
+    {1, 8, 4, 1.292, 1.3, 10.5},
+    {1, 9, 5, 1.296, -1.1, 9.2},
+    {1, 10, 6, 1.282, 1.2, 8.4},
+    {2, 3, 1, 1.199, -3.6, 16.2},
+    {2, 4, 2, 1.179, 1.1, 16.0},
+    {2, 5, 3, 1.154, -2.7, 14.7},
+    {2, 6, 4, 1.132, 1.6, 12.9},
+    {2, 7, 3, 1.297, -5.1, 22.6},
+    {2, 8, 4, 1.251, 3.1, 20.1},
+    {2, 9, 5, 1.241, -2.6, 18.5},
+    {2, 10, 6, 1.216, 2.9, 17.7},
+    {3, 3, 1, 1.085, -1.5, 29.4},
+    {3, 4, 2, 1.070, 7.1, 26.0},
+    {3, 5, 3, 1.135, -4.2, 21.8},
+    {3, 6, 4, 1.129, 1.4, 17.6},
+    {3, 7, 3, 1.220, -4.3, 34.6},
+    {3, 8, 4, 1.213, 7.1, 33.6},
+    {3, 9, 5, 1.188, 0.6, 36.6},
+    {3, 10, 6, 1.202, 7.4, 36.5}}},
+  // WeightedScore: 800 positions, samples by stage: 199 230 199 68
+  {"WeightedScore",
+   {{0, 3, 1, 0.826, 0.2, 1.3},
+    {0, 4, 2, 0.869, -0.2, 1.1},
+    {0, 5, 3, 0.886, 0.4, 1.0},
+    {0, 6, 4, 0.887, -0.1, 0.8},
+    {0, 7, 3, 0.855, 0.5, 1.0},
+    {0, 8, 4, 0.843, -0.2, 1.0},
+    {0, 9, 5, 0.876, 0.3, 1.0},
+    {0, 10, 6, 0.932, -0.2, 0.9},
+    {1, 3, 1, 0.947, -0.1, 2.0},
+    {1, 4, 2, 0.982, 0.1, 1.3},
+    {1, 5, 3, 0.946, 0.1, 1.2},
+    {1, 6, 4, 0.975, 0.1, 1.0},
+    {1, 7, 3, 0.964, 0.2, 1.8},
+    {1, 8, 4, 0.989, 0.2, 1.6},
+    {1, 9, 5, 1.032, 0.1, 1.6},
+    {1, 10, 6, 1.062, 0.3, 1.6},
+    {2, 3, 1, 0.922, -0.7, 3.0},
+    {2, 4, 2, 0.946, 0.2, 2.0},
+    {2, 5, 3, 0.960, -0.1, 1.9},
+    {2, 6, 4, 0.967, 0.2, 2.0},
+    {2, 7, 3, 0.937, 0.0, 3.0},
+    {2, 8, 4, 0.963, 0.4, 3.1},
+    {2, 9, 5, 1.000, -0.2, 3.3},
+    {2, 10, 6, 1.033, 0.4, 3.5},
+    {3, 3, 1, 0.923, -1.7, 4.3},
+    {3, 4, 2, 0.971, 0.4, 3.4},
+    {3, 5, 3, 0.945, 0.0, 4.0},
+    {3, 6, 4, 0.946, 0.3, 3.6},
+    {3, 7, 3, 0.942, -0.2, 5.6},
+    {3, 8, 4, 0.990, 1.1, 6.0},
+    {3, 9, 5, 1.036, -0.7, 5.8},
+    {3, 10, 6, 1.099, 1.9, 6.6}}},
+};
+
+// 'Less' orders checks by stage and then depth
+bool Less(const ProbCut::Check& x, const ProbCut::Check& y) noexcept {
+  return x.stage < y.stage || x.stage == y.stage && x.depth < y.depth;
+}
+
+} // namespace
+
+size_t ProbCut::shallowDepth(size_t depth) noexcept {
+  if (depth < MinDepth || depth > MaxDepth) return 0;
+  const auto half = depth / 2;
+  return std::max<size_t>(half + (half + depth) % 2, 2 - depth % 2);
+}
+
+ProbCut::Check ProbCut::fit(size_t stage, size_t depth, size_t shallow,
+                            const std::vector<std::pair<int, int>>& samples) {
+  Check result{stage, depth, shallow, 1, 0, 0};
+  if (samples.size() < 3) return result;
+  const auto n = static_cast<double>(samples.size());
+  double sumX = 0, sumY = 0;
+  for (auto [x, y] : samples) {
+    sumX += x;
+    sumY += y;
+  }
+  const auto meanX = sumX / n, meanY = sumY / n;
+  double varX = 0, covXY = 0;
+  for (auto [x, y] : samples) {
+    varX += (x - meanX) * (x - meanX);
+    covXY += (x - meanX) * (y - meanY);
+  }
+  if (varX > 0) result.a = covXY / varX;
+  result.b = meanY - result.a * meanX;
+  double errors = 0;
+  for (auto [x, y] : samples) {
+    const auto error = y - (result.a * x + result.b);
+    errors += error * error;
+  }
+  result.sigma = std::sqrt(errors / (n - 2));
+  return result;
+}
+
+ProbCut::ProbCut(const Score& score, size_t selectivity)
+    : _selectivity(std::min<size_t>(selectivity, MaxSelectivity)) {
+  if (!_selectivity) return;
+  if (const auto i = Calibrations.find(score.toString());
+      i != Calibrations.end())
+    _checks = i->second;
+}
+
+ProbCut::ProbCut(std::vector<Check> checks, size_t selectivity)
+    : _selectivity(std::min<size_t>(selectivity, MaxSelectivity)),
+      _checks(std::move(checks)) {
+  std::stable_sort(_checks.begin(), _checks.end(), Less);
+}
+
+std::span<const ProbCut::Check> ProbCut::checks(size_t stage,
+                                                size_t depth) const noexcept {
+  if (depth < MinDepth || depth > MaxDepth) return {};
+  const auto [first, last] = std::equal_range(
+    _checks.begin(), _checks.end(), Check{stage, depth, 0, 0, 0, 0}, Less);
+  return {first, last};
+}
+
+} // namespace othello
@@ -5,17 +5,17 @@
 namespace othello {
 
 using B = Board;
-using Set = const B::Set&;
+using Set = B::Set;
 
 int Score::printScoreCells(Set myVals, Set opVals, Set empty) const {
   auto myScore = 0, opScore = 0;
   for (size_t row = 0, pos = 0; row < B::Rows; ++row) {
     for (size_t col = 0; col < B::Rows; ++col, ++pos)
-      if (myVals[pos]) {
+      if (B::test(myVals, pos)) {
         const auto s = scoreCell(row, col, pos, myVals, opVals, empty);
         myScore += s;
         std::cout << std::setw(7) << s << " ";
-      } else if (opVals[pos]) {
+      } else if (B::test(opVals, pos)) {
         const auto s = scoreCell(row, col, pos, opVals, myVals, empty);
         opScore += s;
         std::cout << "   (" << std::setw(3) << s << ")";
@@ -28,7 +28,7 @@ int Score::printScoreCells(Set myVals, Set opVals, Set empty) const {
   // make sure the score calculated in this function matches the 'non-debug'
   // scoreCells function (need to remove this assertion if a non-deterministic
   // version of 'scoreCell' is created)
-  assert(scoreCells(myVals, opVals, empty) == myScore - opScore);
+  assert(scoreCells(*this, myVals, opVals, empty) == myScore - opScore);
   return myScore - opScore;
 }
 
@@ -95,23 +95,24 @@ inline auto emptyDown(Set empty, int pos) {
 // least on of the other diagonal edges
 inline auto mine(Set myVals, size_t corner, size_t cornerEdge1,
                  size_t cornerEdge2, size_t otherEdge1, size_t otherEdge2) {
-  return myVals[corner] && myVals[cornerEdge1] && myVals[cornerEdge2] &&
-         (myVals[otherEdge1] || myVals[otherEdge2]);
+  return B::test(myVals, corner) && B::test(myVals, cornerEdge1) &&
+         B::test(myVals, cornerEdge2) &&
+         B::test(myVals, otherEdge1, otherEdge2);
 }
 template<int INC, int EDGE_INC, int HIGH, int LOW>
 inline bool mineCenter(Set myVals, int pos) {
   auto i = pos + INC;
   for (; i < HIGH; i += INC)
-    if (!myVals[static_cast<size_t>(i)]) break;
+    if (!B::test(myVals, i)) break;
   if (i >= HIGH) {
     for (i = pos + EDGE_INC - INC; i < HIGH + EDGE_INC; i += INC)
-      if (!myVals[static_cast<size_t>(i)]) break;
+      if (!B::test(myVals, i)) break;
     if (i >= HIGH + EDGE_INC) return true;
   }
   for (i = pos - INC; i >= LOW; i -= INC)
-    if (!myVals[static_cast<size_t>(i)]) return false;
+    if (!B::test(myVals, i)) return false;
   for (i = pos + EDGE_INC + INC; i >= LOW + EDGE_INC; i -= INC)
-    if (!myVals[static_cast<size_t>(i)]) return false;
+    if (!B::test(myVals, i)) return false;
   return true;
 }
 
@@ -185,4 +186,22 @@ int WeightedScore::scoreCell(size_t row, size_t col, size_t, Set, Set,
   return WeightedScoreValues[row][col];
 }
 
+template<typename T>
+int Score::scoreCells(const T& s, Set myVals, Set opVals, Set empty) {
+  auto result = 0;
+  for (auto pos : B::Bits(myVals))
+    result += s.scoreCell(pos / B::Rows, pos % B::Rows, pos, myVals, opVals,
+                          empty);
+  for (auto pos : B::Bits(opVals))
+    result -= s.scoreCell(pos / B::Rows, pos % B::Rows, pos, opVals, myVals,
+                          empty);
+  return result;
+}
+
+// 'Score' is used for virtual calls and each final class gets its own version
+// (with 'scoreCell' inlined) for 'staticScore'
+template int Score::scoreCells(const Score&, Set, Set, Set);
+template int Score::scoreCells(const FullScore&, Set, Set, Set);
+template int Score::scoreCells(const WeightedScore&, Set, Set, Set);
+
 } // namespace othello
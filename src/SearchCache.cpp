@@ -0,0 +1,70 @@
+#include <othello/SearchCache.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace othello {
+
+uint64_t SearchCache::config(const Score& score, size_t depth,
+                             size_t selectivity) {
+  // FNV-1a hash of the score type, depth and selectivity (which is left out
+  // when it's 0 so full-width configs match older cache files)
+  auto name = score.toString() + '/' + std::to_string(depth);
+  if (selectivity) name += "/s" + std::to_string(selectivity);
+  uint64_t result = 0xcbf29ce484222325ULL;
+  for (auto c : name) {
+    result ^= static_cast<unsigned char>(c);
+    result *= 0x100000001b3ULL;
+  }
+  return result;
+}
+
+SearchCache::SearchCache(std::string file, uint64_t config)
+    : _fileName(std::move(file)), _config(config), _file(_fileName) {
+  if (_file.size() < sizeof(Header)) return;
+  const auto& header = *reinterpret_cast<const Header*>(_file.data());
+  if (header.magic != Magic || header.config != _config ||
+      header.entries > (_file.size() - sizeof(Header)) / sizeof(Entry))
+    return; // start with an empty cache
+  _entries = {reinterpret_cast<const Entry*>(_file.data() + sizeof(Header)),
+              static_cast<size_t>(header.entries)};
+}
+
+std::optional<SearchCache::Entry> SearchCache::find(Board::Set hash) const {
+  if (const auto i = _added.find(hash); i != _added.end()) return i->second;
+  const auto i = std::lower_bound(
+    _entries.begin(), _entries.end(), hash,
+    [](const Entry& e, Board::Set h) { return e.hash < h; });
+  if (i == _entries.end() || i->hash != hash) return {};
+  return *i;
+}
+
+size_t SearchCache::size() const {
+  auto result = _added.size();
+  for (auto& i : _entries)
+    if (!_added.contains(i.hash)) ++result;
+  return result;
+}
+
+bool SearchCache::flush() const {
+  std::vector<Entry> entries;
+  entries.reserve(_entries.size() + _added.size());
+  for (auto& i : _entries)
+    if (!_added.contains(i.hash)) entries.push_back(i);
+  for (auto& i : _added) entries.push_back(i.second);
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& x, const Entry& y) { return x.hash < y.hash; });
+  const auto temp = _fileName + ".tmp";
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    const Header header{Magic, _config, entries.size()};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+    if (!out.flush()) return false;
+  }
+  return std::rename(temp.c_str(), _fileName.c_str()) == 0;
+}
+
+} // namespace othello
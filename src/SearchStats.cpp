@@ -0,0 +1,67 @@
+#include <othello/SearchStats.h>
+
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+namespace othello {
+
+double SearchStats::nodesPerSecond() const noexcept {
+  if (time.count() <= 0) return 0;
+  return static_cast<double>(nodes + leaves) * 1'000'000'000.0 /
+         static_cast<double>(time.count());
+}
+
+double SearchStats::branchingFactor() const noexcept {
+  if (!depth) return 0;
+  return std::pow(static_cast<double>(nodes + leaves),
+                  1.0 / static_cast<double>(depth));
+}
+
+double SearchStats::firstMoveCutoffs() const noexcept {
+  const auto total = std::accumulate(cutoffs.begin(), cutoffs.end(), 0LL);
+  return total ? static_cast<double>(cutoffs[0]) / static_cast<double>(total)
+               : 0;
+}
+
+SearchStats& SearchStats::operator+=(const SearchStats& x) noexcept {
+  nodes += x.nodes;
+  leaves += x.leaves;
+  for (size_t i = 0; i < CutoffIndexes; ++i) cutoffs[i] += x.cutoffs[i];
+  tableProbes += x.tableProbes;
+  tableHits += x.tableHits;
+  tableStores += x.tableStores;
+  probCuts += x.probCuts;
+  depth = std::max(depth, x.depth);
+  for (size_t i = 0; i < depthTimes.size(); ++i)
+    depthTimes[i] += x.depthTimes[i];
+  time += x.time;
+  return *this;
+}
+
+std::ostream& operator<<(std::ostream& os, const SearchStats& s) {
+  const auto seconds = [](SearchStats::Time t) {
+    return static_cast<double>(t.count()) / 1'000'000'000.0;
+  };
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << "nodes " << s.nodes << ", leaves " << s.leaves << ", "
+     << std::setprecision(0) << std::fixed << s.nodesPerSecond()
+     << " nodes/sec, depth " << s.depth << ", branching factor "
+     << std::setprecision(2) << s.branchingFactor() << "\n  cutoffs by move:";
+  for (auto i : s.cutoffs) os << ' ' << i;
+  os << " (first move " << std::setprecision(1) << s.firstMoveCutoffs() * 100
+     << "%)\n  table probes " << s.tableProbes << ", hits " << s.tableHits
+     << ", stores " << s.tableStores;
+  if (s.probCuts) os << ", probcuts " << s.probCuts;
+  os << "\n  time " << std::setprecision(6) << seconds(s.time) << " secs";
+  if (s.depth) {
+    os << ", by depth:";
+    for (size_t i = 0; i < s.depth; ++i) os << ' ' << seconds(s.depthTimes[i]);
+  }
+  os.flags(flags);
+  os.precision(precision);
+  return os;
+}
+
+} // namespace othello
@@ -0,0 +1,82 @@
+#include <othello/TranspositionTable.h>
+
+namespace othello {
+
+namespace {
+
+// relaxed ordering is enough since entries are verified using the key
+constexpr auto Relaxed = std::memory_order_relaxed;
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+  const auto buckets = megabytes * 1024 * 1024 / sizeof(Bucket);
+  if (buckets) _buckets = std::vector<Bucket>(std::bit_floor(buckets));
+}
+
+std::optional<TranspositionTable::Entry> TranspositionTable::probe(
+  Board::Set hash) const noexcept {
+  if (_buckets.empty()) return {};
+  for (auto& i : bucket(hash).slots) {
+    const auto data = i.data.load(Relaxed);
+    if (data && (i.key.load(Relaxed) ^ data) == hash) return unpack(data);
+  }
+  return {};
+}
+
+void TranspositionTable::store(Board::Set hash, size_t depth, Bound bound,
+                               int score, size_t move) noexcept {
+  if (_buckets.empty() || !depth) return;
+  const Entry entry{score,
+                    static_cast<uint8_t>(std::min<size_t>(depth, UINT8_MAX)),
+                    bound, static_cast<uint8_t>(move)};
+  auto& slots = bucket(hash).slots;
+  // find the same position or else the entry that's least useful to keep
+  // (lower value): empty entries first, then older generations and finally
+  // lower depths
+  Slot* replace = nullptr;
+  int replaceValue = 0;
+  for (auto& i : slots) {
+    const auto data = i.data.load(Relaxed);
+    if (data && (i.key.load(Relaxed) ^ data) == hash) {
+      replace = &i;
+      break;
+    }
+    const auto value = !data ? -1
+                       : generation(data) != _generation
+                         ? unpack(data).depth
+                         : unpack(data).depth + 256;
+    if (!replace || value < replaceValue) {
+      replace = &i;
+      replaceValue = value;
+    }
+  }
+  const auto data = pack(entry, _generation);
+  replace->key.store(hash ^ data, Relaxed);
+  replace->data.store(data, Relaxed);
+}
+
+void TranspositionTable::clear() noexcept {
+  for (auto& i : _buckets)
+    for (auto& j : i.slots) {
+      j.key.store(0, Relaxed);
+      j.data.store(0, Relaxed);
+    }
+}
+
+uint64_t TranspositionTable::pack(const Entry& e, uint8_t generation) noexcept {
+  return static_cast<uint32_t>(e.score) |
+         static_cast<uint64_t>(e.depth) << 32 |
+         static_cast<uint64_t>(e.bound) << 40 |
+         static_cast<uint64_t>(e.move) << 48 |
+         static_cast<uint64_t>(generation) << 56;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(uint64_t data) noexcept {
+  return {static_cast<int32_t>(static_cast<uint32_t>(data)),
+          static_cast<uint8_t>(data >> 32),
+          static_cast<Bound>(static_cast<uint8_t>(data >> 40)),
+          static_cast<uint8_t>(data >> 48)};
+}
+
+} // namespace othello
@@ -0,0 +1,53 @@
+#include "Allocations.h"
+
+#include <gtest/gtest.h>
+
+#include <othello/Game.h>
+
+#include <iostream>
+
+namespace othello {
+
+using C = Board::Color;
+
+class AllocationTest : public ::testing::Test {
+protected:
+  // discard output printed by 'Game' during the test
+  struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+  };
+
+  void SetUp() override { _cout = std::cout.rdbuf(&_null); }
+  void TearDown() override { std::cout.rdbuf(_cout); }
+
+  // 'allocationsFor' returns the number of allocations made while playing a
+  // tournament of 'matches' games between two new computer players (the
+  // players are created before counting starts)
+  static size_t allocationsFor(size_t matches) {
+    const auto full = std::make_shared<FullScore>();
+    Game game(std::make_unique<ComputerPlayer>(C::Black, 4, false, full,
+                                               Opts{.tableMegabytes = 1}),
+              std::make_unique<ComputerPlayer>(C::White, 4, false, full,
+                                               Opts{.tableMegabytes = 1}),
+              matches);
+    const auto before = allocations();
+    game.begin();
+    return allocations() - before;
+  }
+private:
+  using Opts = ComputerPlayer::Options;
+
+  NullBuffer _null;
+  std::streambuf* _cout = nullptr;
+};
+
+TEST_F(AllocationTest, NoAllocationsAfterFirstGame) {
+  // moves are passed around in fixed size lists so once a game has been played
+  // (to create tables and statics) playing more games doesn't allocate. The
+  // first call warms up statics used by 'Game' and 'ComputerPlayer'.
+  allocationsFor(1);
+  const auto oneGame = allocationsFor(1);
+  EXPECT_EQ(allocationsFor(3), oneGame);
+}
+
+} // namespace othello
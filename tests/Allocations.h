@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+namespace othello {
+
+// 'allocations' returns the number of heap allocations made so far by the
+// program (it's only defined for 'othello_alloc_test' which replaces all the
+// global 'operator new' and 'operator delete' functions to count them)
+size_t allocations();
+
+} // namespace othello
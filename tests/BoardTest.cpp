@@ -4,8 +4,14 @@
 
 namespace othello {
 
-class BoardTest : public ::testing::Test {
+// run all tests for each flip kernel supported by the CPU
+class BoardTest : public ::testing::TestWithParam<Board::FlipKernel> {
 protected:
+  void SetUp() override {
+    if (!Board::setFlipKernel(GetParam()))
+      GTEST_SKIP() << GetParam() << " flip kernel not supported";
+  }
+  void TearDown() override { Board::setFlipKernel(_kernel); }
   void set(size_t emptyRows, const std::string& initialLayout) {
     board = Board(initialLayout, emptyRows * Board::Rows);
   }
@@ -18,17 +24,25 @@ protected:
     EXPECT_EQ(board.toString(),
               expected + std::string(Board::Size - expected.size(), '.'));
   }
+  // 'validMoves' returns the valid moves of 'board' as strings
+  std::vector<std::string> validMoves(Board::Color c) const {
+    std::vector<std::string> result;
+    for (auto i : board.validMoves(c)) result.emplace_back(i.toString());
+    return result;
+  }
   Board board;
+private:
+  const Board::FlipKernel _kernel = Board::flipKernel();
 };
 
-TEST_F(BoardTest, BoardSize) {
-  // 'board' should be 16 bytes (128 bits)
-  EXPECT_EQ(sizeof(board), 16);
+TEST_P(BoardTest, BoardSize) {
+  // 'board' should be 24 bytes (64 bits for each color plus a 64 bit hash)
+  EXPECT_EQ(sizeof(board), 24);
   // 'long long' should be 8 bytes (64 bits)
   EXPECT_EQ(sizeof(1LL), 8);
 }
 
-TEST_F(BoardTest, Scores) {
+TEST_P(BoardTest, Scores) {
   // Initial score
   EXPECT_EQ(board.blackCount(), 2);
   EXPECT_EQ(board.whiteCount(), 2);
@@ -38,12 +52,12 @@ TEST_F(BoardTest, Scores) {
   EXPECT_EQ(board.whiteCount(), 1);
 }
 
-TEST_F(BoardTest, ValidMoves) {
+TEST_P(BoardTest, ValidMoves) {
   ASSERT_TRUE(board.hasValidMoves());
-  const auto blackMoves = board.validMoves(Board::Color::Black);
+  const auto blackMoves = validMoves(Board::Color::Black);
   std::vector<std::string> expectedBlackMoves = {"d3", "c4", "f5", "e6"};
   ASSERT_EQ(blackMoves, expectedBlackMoves);
-  const auto whiteMoves = board.validMoves(Board::Color::White);
+  const auto whiteMoves = validMoves(Board::Color::White);
   std::vector<std::string> expectedWhiteMoves = {"e3", "f4", "c5", "d6"};
   ASSERT_EQ(whiteMoves, expectedWhiteMoves);
   set("\
@@ -59,36 +73,256 @@ TEST_F(BoardTest, ValidMoves) {
   EXPECT_EQ(moves.size(), 30);
 }
 
-TEST_F(BoardTest, ValidMovesWithArrays) {
-  Board::Boards boards;
-  Board::Positions positions;
-  const auto result = board.validMoves(Board::Color::Black, boards, positions);
-  ASSERT_EQ(result, 4);
-  EXPECT_EQ(positions[0], 19);
-  EXPECT_EQ(positions[1], 26);
-  EXPECT_EQ(positions[2], 37);
-  EXPECT_EQ(positions[3], 44);
-  board = boards[0];
+TEST_P(BoardTest, Moves) {
+  const Board::Move pass;
+  EXPECT_TRUE(pass.pass());
+  EXPECT_EQ(pass.toString(), "pass");
+  EXPECT_EQ(sizeof(pass), 1);
+  const Board::Move e6(44);
+  EXPECT_FALSE(e6.pass());
+  EXPECT_EQ(e6.toString(), "e6");
+  EXPECT_EQ(Board::toPos("e6"), 44);
+  EXPECT_EQ(Board::toPos("e"), Board::BadSize);
+  EXPECT_EQ(Board::toPos("i6"), Board::BadColumn);
+  EXPECT_EQ(Board::toPos("e9"), Board::BadRow);
+  const auto moves = board.validMoves(Board::Color::Black);
+  const Board::Moves expected = {Board::Move(19), Board::Move(26),
+                                 Board::Move(37), Board::Move(44)};
+  EXPECT_EQ(moves, expected);
+  EXPECT_EQ(moves[3], e6);
+  Board::Moves positions;
+  const auto bits = board.validMoveBits(Board::Color::Black);
+  positions.assign(bits.begin(), bits.end());
+  EXPECT_EQ(positions, moves);
+  ASSERT_EQ(board.set(e6, Board::Color::Black), 1);
+  EXPECT_EQ(board.blackCount(), 4);
+}
+
+TEST_P(BoardTest, ValidMoveBits) {
+  const auto blackMoves = board.validMoveBits(Board::Color::Black);
+  EXPECT_EQ(blackMoves.count(), 4);
+  EXPECT_EQ(blackMoves.mask(),
+            (1ULL << 19) | (1ULL << 26) | (1ULL << 37) | (1ULL << 44));
+  std::vector<size_t> positions(blackMoves.begin(), blackMoves.end());
+  EXPECT_EQ(positions, (std::vector<size_t>{19, 26, 37, 44}));
+  // no moves for either color on an empty or full board
+  for (auto layout : {std::string(), std::string(Board::Size, '*')}) {
+    set(layout);
+    for (auto c : Board::Colors) EXPECT_TRUE(board.validMoveBits(c).empty());
+  }
+}
+
+TEST_P(BoardTest, ValidMoveBitsMatchSet) {
+  // every cell in the mask must flip at least one disk and every empty cell
+  // not in the mask must be rejected by 'set' (check edges and wrap-arounds)
+  for (auto& layout : {std::string("\
+.o*oo*o.\
+o.o..o.o\
+*o*..*o*\
+.o.oo.o.\
+*.*..*.*\
+oo.**.oo\
+*.o..o.*\
+.*o..o*."),
+                       std::string("\
+......o*\
+*o......\
+.......o\
+o*......\
+*......o\
+.......*\
+o.......\
+*o....o*")}) {
+    set(layout);
+    for (auto c : Board::Colors) {
+      const auto moves = board.validMoveBits(c).mask();
+      for (size_t i = 0; i < Board::Size; ++i)
+        if (layout[i] == Board::EmptyCell) {
+          auto b = board;
+          EXPECT_EQ(b.set(Board::posToString(i), c) > 0, (moves >> i & 1) == 1)
+            << Board::posToString(i) << " for " << c;
+        } else
+          EXPECT_FALSE(moves >> i & 1);
+    }
+  }
+}
+
+TEST_P(BoardTest, Children) {
+  std::vector<Board::Child> children;
+  for (const auto& child : board.children(Board::Color::Black))
+    children.push_back(child);
+  ASSERT_EQ(children.size(), 4);
+  EXPECT_EQ(children[0].pos, 19);
+  EXPECT_EQ(children[1].pos, 26);
+  EXPECT_EQ(children[2].pos, 37);
+  EXPECT_EQ(children[3].pos, 44);
+  const auto parent = board;
+  board = children[0].board;
   check(2, "\
 ...*....\
 ...**...\
 ...*o");
-  board = boards[1];
+  board = children[1].board;
   check(3, "\
 ..***...\
 ...*o");
-  board = boards[2];
+  board = children[2].board;
   check(3, "\
 ...o*...\
 ...***");
-  board = boards[3];
+  board = children[3].board;
   check(3, "\
 ...o*...\
 ...**...\
 ....*");
+  // visit children in a given order (for example, from a move ordering)
+  std::vector<size_t> positions;
+  for (const auto& child : parent.children(Board::Color::Black,
+                                           std::array<size_t, 2>{44, 19})) {
+    positions.push_back(child.pos);
+    EXPECT_EQ(child.board, children[child.pos == 19 ? 0 : 3].board);
+  }
+  EXPECT_EQ(positions, (std::vector<size_t>{44, 19}));
 }
 
-TEST_F(BoardTest, ToStream) {
+TEST_P(BoardTest, MakeAndUnmakeMove) {
+  const auto initial = board;
+  for (auto c : Board::Colors)
+    for (auto pos : initial.validMoveBits(c)) {
+      auto expected = initial;
+      ASSERT_EQ(expected.set(pos, c), 1);
+      const auto undo = board.makeMove(pos, c);
+      EXPECT_EQ(board, expected);
+      EXPECT_EQ(std::popcount(undo.flips), 1);
+      EXPECT_EQ(undo.pos, pos);
+      EXPECT_EQ(undo.color, c);
+      board.unmakeMove(undo);
+      EXPECT_EQ(board, initial);
+    }
+  // make a sequence of moves and then unmake them in reverse order
+  std::vector<std::pair<Board, Board::Undo>> moves;
+  for (auto c = Board::Color::Black; moves.size() < 10; c = Board::opColor(c))
+    if (const auto valid = board.validMoveBits(c); !valid.empty()) {
+      const auto before = board;
+      moves.emplace_back(before, board.makeMove(*valid.begin(), c));
+    }
+  for (auto i = moves.rbegin(); i != moves.rend(); ++i) {
+    board.unmakeMove(i->second);
+    EXPECT_EQ(board, i->first);
+  }
+}
+
+TEST_P(BoardTest, Hash) {
+  using C = Board::Color;
+  EXPECT_NE(board.hash(C::Black), board.hash(C::White));
+  EXPECT_EQ(board.hash(C::Black), Board(board.toString()).hash(C::Black));
+  // hash is updated incrementally by 'makeMove' and 'set' and must match the
+  // hash of a board created from scratch
+  const auto initial = board;
+  auto other = board;
+  auto c = C::Black;
+  for (auto i = 0; i < 30 && board.hasValidMoves();
+       ++i, c = Board::opColor(c)) {
+    const auto moves = board.validMoveBits(c);
+    if (moves.empty()) continue; // skip turn
+    const auto pos = *moves.begin();
+    board.makeMove(pos, c);
+    ASSERT_GT(other.set(Board::posToString(pos), c), 0);
+    const auto expected = Board(board.toString());
+    EXPECT_EQ(board.hash(c), expected.hash(c));
+    EXPECT_EQ(other.hash(c), expected.hash(c));
+  }
+  // 'unmakeMove' restores the previous hash
+  board = initial;
+  const auto undo = board.makeMove(19, C::Black);
+  EXPECT_NE(board.hash(C::White), initial.hash(C::White));
+  board.unmakeMove(undo);
+  EXPECT_EQ(board.hash(C::White), initial.hash(C::White));
+  // transpositions (same position from different move orders) have the same
+  // hash, i.e., 'd3 c3 c4 e3' and 'c4 c3 d3 e3'
+  auto b1 = initial, b2 = initial;
+  const std::array moves1 = {"d3", "c3", "c4", "e3"},
+                   moves2 = {"c4", "c3", "d3", "e3"};
+  for (size_t i = 0; i < moves1.size(); ++i) {
+    c = i % 2 ? C::White : C::Black;
+    ASSERT_GT(b1.set(moves1[i], c), 0);
+    ASSERT_GT(b2.set(moves2[i], c), 0);
+  }
+  EXPECT_EQ(b1, b2);
+  EXPECT_EQ(b1.hash(C::Black), b2.hash(C::Black));
+}
+
+TEST_P(BoardTest, Symmetries) {
+  using S = Board::Symmetry;
+  // compare the bit-parallel transforms with simple per-cell remapping
+  const auto expected = [](size_t pos, S sym) -> size_t {
+    const auto row = pos / Board::Rows, col = pos % Board::Rows, last = 7UL;
+    switch (sym) {
+    case S::Identity: return pos;
+    case S::FlipColumns: return row * Board::Rows + last - col;
+    case S::FlipRows: return (last - row) * Board::Rows + col;
+    case S::Rotate180: return Board::SizeSub1 - pos;
+    case S::FlipDiagonal: return col * Board::Rows + row;
+    case S::RotateClockwise: return col * Board::Rows + last - row;
+    case S::RotateCounterClockwise: return (last - col) * Board::Rows + row;
+    case S::FlipAntiDiagonal:
+      return (last - col) * Board::Rows + last - row;
+    }
+    return Board::Size;
+  };
+  for (auto sym : Board::Symmetries)
+    for (size_t pos = 0; pos < Board::Size; ++pos) {
+      const auto result = Board::transformPos(pos, sym);
+      EXPECT_EQ(result, expected(pos, sym));
+      EXPECT_EQ(Board::transformPos(result, Board::inverse(sym)), pos);
+    }
+  EXPECT_EQ(Board::transformPos(0, S::RotateClockwise), 7);   // a1 -> h1
+  EXPECT_EQ(Board::transformPos(7, S::RotateClockwise), 63);  // h1 -> h8
+  EXPECT_EQ(Board::transformPos(0, S::FlipAntiDiagonal), 63); // a1 -> h8
+  // transforming a board also transforms its cells and hash
+  set(".*o");
+  const auto rotated = board.transform(S::RotateClockwise);
+  EXPECT_EQ(rotated, Board(1, ".......*.......o")); // b1 -> h2, c1 -> h3
+  EXPECT_EQ(rotated.hash(Board::Color::Black),
+            Board(rotated.toString()).hash(Board::Color::Black));
+  EXPECT_EQ(rotated.transform(S::RotateCounterClockwise), board);
+}
+
+TEST_P(BoardTest, Canonical) {
+  using C = Board::Color;
+  // the initial board is symmetric across both diagonals
+  const auto [initial, initialSym] = board.canonical();
+  EXPECT_EQ(initial, board);
+  EXPECT_EQ(initialSym, Board::Symmetry::Identity);
+  // all first moves are equivalent so they lead to the same canonical board
+  std::vector<Board> results;
+  for (auto [pos, child] : board.children(C::Black)) {
+    const auto [canonical, sym] = child.canonical();
+    EXPECT_EQ(child.transform(sym), canonical);
+    // the canonical move maps back to the move that was played
+    const auto canonicalMove = Board::transformPos(pos, sym);
+    EXPECT_EQ(Board::transformPos(canonicalMove, Board::inverse(sym)), pos);
+    results.push_back(canonical);
+  }
+  ASSERT_EQ(results.size(), 4);
+  for (auto& i : results) EXPECT_EQ(i, results[0]);
+  // every transform of a position has the same canonical board and valid
+  // moves for the canonical board map back to valid moves
+  set(2, "...*o.....*oo.....o*o.....**");
+  const auto [canonical, sym] = board.canonical();
+  for (auto s : Board::Symmetries)
+    EXPECT_EQ(board.transform(s).canonical().first, canonical);
+  const auto moves = board.validMoveBits(C::White);
+  size_t count = 0;
+  for (auto pos : canonical.validMoveBits(C::White)) {
+    EXPECT_TRUE(
+      Board::test(moves.mask(), Board::transformPos(pos, Board::inverse(sym))));
+    ++count;
+  }
+  EXPECT_EQ(count, moves.count());
+}
+
+TEST_P(BoardTest, ToStream) {
   const auto expected = "\
    a b c d e f g h\n\
  +----------------\n\
@@ -105,13 +339,13 @@ TEST_F(BoardTest, ToStream) {
   EXPECT_EQ(ss.str(), expected);
 }
 
-TEST_F(BoardTest, ToString) {
+TEST_P(BoardTest, ToString) {
   check(3, "\
 ...o*...\
 ...*o");
 }
 
-TEST_F(BoardTest, FlipUp) {
+TEST_P(BoardTest, FlipUp) {
   ASSERT_EQ(board.set("d6", Board::Color::White), 1);
   check(3, "\
 ...o*...\
@@ -125,7 +359,7 @@ TEST_F(BoardTest, FlipUp) {
   }
 }
 
-TEST_F(BoardTest, FlipDown) {
+TEST_P(BoardTest, FlipDown) {
   ASSERT_EQ(board.set("d3", Board::Color::Black), 1);
   check(2, "\
 ...*....\
@@ -141,7 +375,7 @@ TEST_F(BoardTest, FlipDown) {
   }
 }
 
-TEST_F(BoardTest, FlipLeft) {
+TEST_P(BoardTest, FlipLeft) {
   ASSERT_EQ(board.set("f4", Board::Color::White), 1);
   check(3, "\
 ...ooo..\
@@ -153,7 +387,7 @@ TEST_F(BoardTest, FlipLeft) {
   ASSERT_EQ(board.set("c1", Board::Color::Black), 0);
 }
 
-TEST_F(BoardTest, FlipRight) {
+TEST_P(BoardTest, FlipRight) {
   ASSERT_EQ(board.set("c5", Board::Color::White), 1);
   check(3, "\
 ...o*...\
@@ -165,7 +399,7 @@ TEST_F(BoardTest, FlipRight) {
   ASSERT_EQ(board.set("f8", Board::Color::Black), 0);
 }
 
-TEST_F(BoardTest, FlipUpLeft) {
+TEST_P(BoardTest, FlipUpLeft) {
   ASSERT_EQ(board.set("e6", Board::Color::Black), 1);
   ASSERT_EQ(board.set("f6", Board::Color::White), 1);
   check(3, "\
@@ -174,7 +408,7 @@ TEST_F(BoardTest, FlipUpLeft) {
 ....*o");
 }
 
-TEST_F(BoardTest, FlipUpRight) {
+TEST_P(BoardTest, FlipUpRight) {
   ASSERT_EQ(board.set("d6", Board::Color::White), 1);
   ASSERT_EQ(board.set("c6", Board::Color::Black), 1);
   check(3, "\
@@ -183,7 +417,7 @@ TEST_F(BoardTest, FlipUpRight) {
 ..*o");
 }
 
-TEST_F(BoardTest, FlipDownLeft) {
+TEST_P(BoardTest, FlipDownLeft) {
   ASSERT_EQ(board.set("e3", Board::Color::White), 1);
   ASSERT_EQ(board.set("f3", Board::Color::Black), 1);
   check(2, "\
@@ -192,7 +426,7 @@ TEST_F(BoardTest, FlipDownLeft) {
 ...*o");
 }
 
-TEST_F(BoardTest, FlipDownRight) {
+TEST_P(BoardTest, FlipDownRight) {
   ASSERT_EQ(board.set("d3", Board::Color::Black), 1);
   ASSERT_EQ(board.set("c3", Board::Color::White), 1);
   check(2, "\
@@ -201,14 +435,14 @@ TEST_F(BoardTest, FlipDownRight) {
 ...*o");
 }
 
-TEST_F(BoardTest, MultipleFlipsDown) {
+TEST_P(BoardTest, MultipleFlipsDown) {
   for (size_t i = 0; i < Board::RowSub2; ++i) {
     set(i + 1, "\
 ...***..\
 ..ooooo");
     std::vector<std::string> moves = {"c", "d", "e", "f", "g"};
     for (auto& m : moves) m += std::to_string(i + 1);
-    ASSERT_EQ(board.validMoves(Board::Color::White), moves);
+    ASSERT_EQ(validMoves(Board::Color::White), moves);
     ASSERT_EQ(board.set(moves[2], Board::Color::White), 3);
     check(i, "\
 ....o...\
@@ -217,14 +451,14 @@ TEST_F(BoardTest, MultipleFlipsDown) {
   }
 }
 
-TEST_F(BoardTest, MultipleFlipsUp) {
+TEST_P(BoardTest, MultipleFlipsUp) {
   for (size_t i = 0; i < Board::RowSub2; ++i) {
     set(i, "\
 ..*****.\
 ...ooo");
     std::vector<std::string> moves = {"c", "d", "e", "f", "g"};
     for (auto& m : moves) m += std::to_string(i + 3);
-    ASSERT_EQ(board.validMoves(Board::Color::Black), moves);
+    ASSERT_EQ(validMoves(Board::Color::Black), moves);
     ASSERT_EQ(board.set(moves[2], Board::Color::Black), 3);
     check(i, "\
 ..*****.\
@@ -233,7 +467,7 @@ TEST_F(BoardTest, MultipleFlipsUp) {
   }
 }
 
-TEST_F(BoardTest, MultipleFlipsLeft) {
+TEST_P(BoardTest, MultipleFlipsLeft) {
   for (size_t i = 0; i < Board::RowSub2; ++i) {
     const auto f = [i](const char* s) {
       std::string result(i, '.');
@@ -245,13 +479,13 @@ TEST_F(BoardTest, MultipleFlipsLeft) {
     for (size_t j = 1; j < Board::RowSub2; ++j)
       moves.emplace_back(std::string(1, 'c' + static_cast<char>(i)) +
                          std::to_string(j));
-    ASSERT_EQ(board.validMoves(Board::Color::White), moves);
+    ASSERT_EQ(validMoves(Board::Color::White), moves);
     ASSERT_EQ(board.set(moves[2], Board::Color::White), 3);
     check(f("o..") + f("oo.") + f("ooo") + f("oo.") + f("o"));
   }
 }
 
-TEST_F(BoardTest, MultipleFlipsRight) {
+TEST_P(BoardTest, MultipleFlipsRight) {
   for (size_t i = 0; i < Board::RowSub2; ++i) {
     const auto f = [i](const char* s) {
       std::string result(i, '.');
@@ -263,13 +497,13 @@ TEST_F(BoardTest, MultipleFlipsRight) {
     for (auto j = 1; j < Board::RowSub2; ++j)
       moves.emplace_back(std::string(1, 'a' + static_cast<char>(i)) +
                          std::to_string(j));
-    ASSERT_EQ(board.validMoves(Board::Color::Black), moves);
+    ASSERT_EQ(validMoves(Board::Color::Black), moves);
     ASSERT_EQ(board.set(moves[2], Board::Color::Black), 3);
     check(f("..*") + f(".**") + f("***") + f(".**") + f("..*"));
   }
 }
 
-TEST_F(BoardTest, FlipHittingRightEdge) {
+TEST_P(BoardTest, FlipHittingRightEdge) {
   set(1, "\
 ......oo\
 *ooooo.o\
@@ -283,7 +517,7 @@ TEST_F(BoardTest, FlipHittingRightEdge) {
 ......*");
 }
 
-TEST_F(BoardTest, FlipHittingBottomEdge) {
+TEST_P(BoardTest, FlipHittingBottomEdge) {
   set("\
 ..o.....\
 ..*.....\
@@ -305,7 +539,7 @@ TEST_F(BoardTest, FlipHittingBottomEdge) {
 .**.....");
 }
 
-TEST_F(BoardTest, FlipHittingLeftEdge) {
+TEST_P(BoardTest, FlipHittingLeftEdge) {
   set("\
 *......*\
 .o.....o\
@@ -327,7 +561,7 @@ ooooooo.");
 ooooooo*");
 }
 
-TEST_F(BoardTest, FlipHittingTopEdge) {
+TEST_P(BoardTest, FlipHittingTopEdge) {
   set("\
 ..o..*..\
 *.o.o...\
@@ -349,7 +583,7 @@ TEST_F(BoardTest, FlipHittingTopEdge) {
 ..*...*.");
 }
 
-TEST_F(BoardTest, SetFailsForBadRowOrColumn) {
+TEST_P(BoardTest, SetFailsForBadRowOrColumn) {
   for (auto v : Board::Colors) {
     // bad lengths
     EXPECT_EQ(board.set("", v), Board::BadSize);
@@ -371,4 +605,10 @@ TEST_F(BoardTest, SetFailsForBadRowOrColumn) {
   }
 }
 
+INSTANTIATE_TEST_SUITE_P(FlipKernels, BoardTest,
+                         ::testing::ValuesIn(Board::FlipKernels),
+                         [](const auto& param) {
+                           return std::string(toString(param.param));
+                         });
+
 } // namespace othello
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <othello/Endgame.h>
+#include <othello/RandomMoves.h>
+
+namespace othello {
+
+using C = Board::Color;
+using Mode = Endgame::Mode;
+
+class EndgameTest : public ::testing::Test {
+protected:
+  // plain negamax to the end of the game (no pruning or move ordering) used to
+  // check the results of 'Endgame'
+  static int exact(Board& b, C c, bool passed = false) {
+    const auto moves = b.validMoveBits(c);
+    if (moves.empty()) {
+      if (passed) {
+        const auto diff = static_cast<int>(b.blackCount()) -
+                          static_cast<int>(b.whiteCount());
+        return c == C::Black ? diff : -diff;
+      }
+      return -exact(b, Board::opColor(c), true);
+    }
+    auto best = -static_cast<int>(Endgame::Inf);
+    for (auto pos : moves) {
+      const auto undo = b.makeMove(pos, c);
+      best = std::max(best, -exact(b, Board::opColor(c)));
+      b.unmakeMove(undo);
+    }
+    return best;
+  }
+};
+
+TEST_F(EndgameTest, FullBoard) {
+  // 40 Black and 24 White
+  Board b(std::string(40, '*') + std::string(24, 'o'));
+  EXPECT_EQ(Endgame().solve(b, C::Black), 16);
+  EXPECT_EQ(Endgame().solve(b, C::White), -16);
+  EXPECT_EQ(Endgame().solve(b, C::White, Mode::WinLossDraw), -1);
+}
+
+TEST_F(EndgameTest, NoMovesForEitherColor) {
+  // empty cells aren't counted when neither color can move
+  const Board b("**********");
+  EXPECT_FALSE(b.hasValidMoves());
+  EXPECT_EQ(Endgame().solve(b, C::White), -10);
+  EXPECT_EQ(Endgame().solve(b, C::Black, Mode::WinLossDraw), 1);
+}
+
+TEST_F(EndgameTest, MatchesNegamax) {
+  std::mt19937 gen(1);
+  for (size_t empties = 1; empties <= 9; ++empties)
+    for (auto i = 0; i < 10; ++i) {
+      auto c = C::Black;
+      auto b = randomBoard(gen, empties, c);
+      const auto expected = exact(b, c);
+      Endgame endgame;
+      EXPECT_EQ(endgame.solve(b, c), expected)
+        << "empties " << empties << '\n'
+        << b;
+      const auto wld = endgame.solve(b, c, Mode::WinLossDraw);
+      EXPECT_EQ(wld, expected > 0 ? 1 : expected < 0 ? -1 : 0);
+    }
+}
+
+TEST_F(EndgameTest, FailSoftBounds) {
+  std::mt19937 gen(2);
+  for (auto i = 0; i < 20; ++i) {
+    auto c = C::Black;
+    auto b = randomBoard(gen, 8, c);
+    const auto expected = exact(b, c);
+    const auto black = c == C::Black;
+    const auto my = black ? b.black() : b.white();
+    const auto op = black ? b.white() : b.black();
+    Endgame endgame;
+    // a window above the result returns an upper bound and a window below it
+    // returns a lower bound
+    EXPECT_LE(endgame.solve(my, op, expected, expected + 2), expected);
+    EXPECT_GE(endgame.solve(my, op, expected - 2, expected), expected);
+    EXPECT_EQ(endgame.solve(my, op, expected - 1, expected + 1), expected);
+  }
+}
+
+TEST_F(EndgameTest, Deadline) {
+  std::mt19937 gen(3);
+  auto c = C::Black;
+  const auto b = randomBoard(gen, 20, c);
+  Endgame endgame(std::chrono::steady_clock::now());
+  endgame.solve(b, c);
+  EXPECT_TRUE(endgame.timedOut());
+  // the clock is checked before searching the first node
+  EXPECT_LE(endgame.nodes(), 1);
+}
+
+} // namespace othello
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <othello/MoveOrdering.h>
+
+namespace othello {
+
+using C = Board::Color;
+
+class MoveOrderingTest : public ::testing::Test {
+protected:
+  auto order(size_t depth = 1, size_t tableMove = MoveOrdering::NoMove) {
+    const auto moves = ordering.order(board, c, board.validMoveBits(c), ply,
+                                      depth, tableMove);
+    std::vector<size_t> result;
+    for (auto i : moves) result.push_back(i.pos());
+    return result;
+  }
+  MoveOrdering ordering;
+  // White can play in a corner (a1), on an edge (d1), next to a corner on an
+  // edge (g8) or diagonally next to a corner (b7)
+  Board board = Board("\
+.*o.*o..\
+*.......\
+o.......\
+........\
+........\
+........\
+..*o....\
+....o*..");
+  C c = C::White;
+  size_t ply = 3;
+};
+
+TEST_F(MoveOrderingTest, StaticOrder) {
+  // corner first, then edge and then cells next to corners
+  EXPECT_EQ(order(), (std::vector<size_t>{0, 3, 62, 49}));
+  // same order when also counting opponent replies
+  EXPECT_EQ(order(MoveOrdering::MobilityDepth), order());
+}
+
+TEST_F(MoveOrderingTest, TableMove) {
+  EXPECT_EQ(order(1, 49), (std::vector<size_t>{49, 0, 3, 62}));
+  // a table move that isn't a valid move is ignored
+  EXPECT_EQ(order(1, 10), order());
+}
+
+TEST_F(MoveOrderingTest, Killers) {
+  ordering.cutoff(c, ply, 62, 4);
+  ordering.cutoff(c, ply, 49, 4);
+  EXPECT_EQ(ordering.killer(ply, 0), 49);
+  EXPECT_EQ(ordering.killer(ply, 1), 62);
+  // killers go before other moves (most recent first), but after table move
+  EXPECT_EQ(order(), (std::vector<size_t>{49, 62, 0, 3}));
+  EXPECT_EQ(order(1, 3), (std::vector<size_t>{3, 49, 62, 0}));
+  // killers are only used for the same ply
+  ++ply;
+  EXPECT_EQ(order(), (std::vector<size_t>{0, 3, 62, 49}));
+  // a repeated killer isn't added twice
+  ordering.cutoff(c, ply, 3, 1);
+  ordering.cutoff(c, ply, 3, 1);
+  EXPECT_EQ(ordering.killer(ply, 0), 3);
+  EXPECT_EQ(ordering.killer(ply, 1), MoveOrdering::NoMove);
+  // killers are cleared for a new search
+  ordering.newSearch();
+  EXPECT_EQ(ordering.killer(ply - 1, 0), MoveOrdering::NoMove);
+}
+
+TEST_F(MoveOrderingTest, History) {
+  // cutoffs at other plies update history (by depth squared) for the color
+  ordering.cutoff(c, 10, 49, 40);
+  EXPECT_EQ(ordering.history(c, 49), 1600);
+  EXPECT_EQ(ordering.history(Board::opColor(c), 49), 0);
+  EXPECT_EQ(order(), (std::vector<size_t>{49, 0, 3, 62}));
+  // history is aged (halved) for a new search
+  ordering.newSearch();
+  EXPECT_EQ(ordering.history(c, 49), 800);
+  // all values are halved if any value gets too big
+  ordering.cutoff(c, 10, 3, 1);
+  ordering.cutoff(c, 10, 49, 1024);
+  EXPECT_EQ(ordering.history(c, 49), (800 + 1024 * 1024) / 2);
+  EXPECT_EQ(ordering.history(c, 3), 0);
+}
+
+} // namespace othello
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <othello/OpeningBook.h>
+
+#include <cstdio>
+#include <fstream>
+
+namespace othello {
+
+using C = Board::Color;
+using Entry = OpeningBook::Entry;
+
+class OpeningBookTest : public ::testing::Test {
+protected:
+  void TearDown() override { std::remove(file.c_str()); }
+
+  // position after Black plays at 'd3' (and its 7 equivalent positions)
+  static Board afterD3() {
+    Board b;
+    b.set("d3", C::Black);
+    return b;
+  }
+
+  const std::string file = "OpeningBookTest.book";
+};
+
+TEST_F(OpeningBookTest, MissingFile) {
+  const OpeningBook book("missing.book");
+  EXPECT_TRUE(book.empty());
+  EXPECT_FALSE(book.move(Board(), C::Black));
+}
+
+TEST_F(OpeningBookTest, BadFile) {
+  std::ofstream(file) << "not a book file";
+  EXPECT_TRUE(OpeningBook(file).empty());
+}
+
+TEST_F(OpeningBookTest, Find) {
+  // entries are sorted when written and duplicate hashes are dropped
+  ASSERT_TRUE(OpeningBook::write(
+    file, {{30, 3, 1, 5}, {10, 1, 2, 5}, {20, 2, 3, 5}, {10, 4, 4, 5}}));
+  const OpeningBook book(file);
+  EXPECT_EQ(book.size(), 3);
+  for (Board::Set key : {10, 20, 30}) {
+    const auto entry = book.find(key);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->score, key / 10);
+  }
+  EXPECT_FALSE(book.find(0));
+  EXPECT_FALSE(book.find(15));
+  EXPECT_FALSE(book.find(40));
+}
+
+TEST_F(OpeningBookTest, MoveForEquivalentPositions) {
+  // store 'c3' (the diagonal reply) for White after 'd3' using the canonical
+  // board and then look up all 8 equivalent positions
+  const auto board = afterD3();
+  const auto [canonical, sym] = board.canonical();
+  Board expected = board;
+  expected.set("c3", C::White);
+  const auto move = Board::transformPos(18 /* c3 */, sym);
+  ASSERT_TRUE(OpeningBook::write(
+    file, {{canonical.hash(C::White), 0, static_cast<uint8_t>(move), 1}}));
+  const OpeningBook book(file);
+  for (auto i : Board::Symmetries) {
+    const auto b = board.transform(i);
+    const auto pos = book.move(b, C::White);
+    ASSERT_TRUE(pos);
+    auto result = b;
+    result.set(*pos, C::White);
+    EXPECT_EQ(result, expected.transform(i));
+  }
+  // the same board with the other color to move isn't in the book
+  EXPECT_FALSE(book.move(board, C::Black));
+}
+
+TEST_F(OpeningBookTest, InvalidMove) {
+  // a stored move that isn't valid (like from a hash collision) is ignored
+  const Board board;
+  ASSERT_TRUE(
+    OpeningBook::write(file, {{OpeningBook::key(board, C::Black), 0, 0, 1}}));
+  EXPECT_FALSE(OpeningBook(file).move(board, C::Black));
+}
+
+} // namespace othello
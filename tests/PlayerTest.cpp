@@ -2,6 +2,11 @@
 #include <gtest/gtest.h>
 
 #include <othello/Player.h>
+#include <othello/RandomMoves.h>
+
+#include <cstdio>
+#include <random>
+#include <thread>
 
 namespace othello {
 
@@ -9,7 +14,7 @@ using ::testing::_;
 using ::testing::Return;
 
 using C = Board::Color;
-using Set = const Board::Set&;
+using Set = Board::Set;
 
 class MockScore : public Score {
 public:
@@ -22,14 +27,53 @@ public:
 
 class PlayerTest : public ::testing::Test {
 protected:
+  // plain min-max (no pruning, table or move ordering) used to check results
+  // of the search done by 'ComputerPlayer'
+  static int minMax(Board& b, size_t depth, C turn, C player, bool prevMoved,
+                    const Score& s) {
+    if (!depth) return s.score(b, player);
+    const auto moves = b.validMoveBits(turn);
+    if (moves.empty())
+      return minMax(b, prevMoved ? depth - 1 : 0, Board::opColor(turn), player,
+                    false, s);
+    auto best = turn == player ? -Score::Win : Score::Win;
+    for (auto pos : moves) {
+      const auto undo = b.makeMove(pos, turn);
+      const auto score =
+        minMax(b, depth - 1, Board::opColor(turn), player, true, s);
+      b.unmakeMove(undo);
+      best = turn == player ? std::max(best, score) : std::min(best, score);
+    }
+    return best;
+  }
+
+  // return the board after the move 'player' should make based on 'minMax',
+  // i.e., the first move (in position order) with the best score (using the
+  // score of the move itself to break ties)
+  static Board bestMove(const Board& b, size_t depth, C player,
+                        const Score& s) {
+    std::optional<std::pair<int, int>> best;
+    Board result;
+    for (auto [pos, child] : b.children(player)) {
+      const auto score = std::pair(
+        minMax(child, depth - 1, Board::opColor(player), player, true, s),
+        s.score(child, player));
+      if (!best || score > *best) {
+        best = score;
+        result = child;
+      }
+    }
+    return result;
+  }
+
   void scoreChildren(const Board& b, C c, int scoreStart, int jump = 1) {
-    Board::Boards boards;
-    const auto moves = b.validMoves(c, boards);
     // use WillRepeatedly instead of WillOnce because some child nodes may not
     // be scored due to alpha-beta pruning
-    for (size_t i = 0; i < moves; ++i, scoreStart += jump)
-      EXPECT_CALL(*score, scoreBoard(boards[i], _, _, _))
+    for (const auto& child : b.children(c)) {
+      EXPECT_CALL(*score, scoreBoard(child.board, _, _, _))
         .WillRepeatedly(Return(scoreStart));
+      scoreStart += jump;
+    }
   }
 
   // 4 initial valid moves for Black
@@ -99,4 +143,338 @@ TEST_F(PlayerTest, MoveDepth2) {
   EXPECT_EQ(board, b2);
 }
 
+TEST_F(PlayerTest, SearchMatchesMinMax) {
+  const auto s = std::make_shared<FullScore>();
+  std::mt19937 gen(1);
+  for (auto plies : {6, 14, 22, 30, 38, 46, 52}) {
+    // play random moves to get a test position
+    Board b;
+    auto c = C::Black;
+    for (auto i = 0; i < plies && randomMove(b, c, gen); ++i) {}
+    if (!b.hasValidMoves(c)) c = Board::opColor(c);
+    ASSERT_TRUE(b.hasValidMoves(c));
+    const auto expected = bestMove(b, 5, c, *s);
+    using Parallel = ComputerPlayer::Parallel;
+    for (size_t table : {0, 1})
+      for (auto ordering : {false, true})
+        for (auto [threads, parallel] :
+             {std::pair<size_t, Parallel>{1, Parallel::RootSplit},
+              {4, Parallel::RootSplit},
+              {4, Parallel::Ybwc}}) {
+          const ComputerPlayer player(c, 5, false, s,
+                                      {.tableMegabytes = table,
+                                       .moveOrdering = ordering,
+                                       .threads = threads,
+                                       .parallel = parallel});
+          auto result = b;
+          player.move(result, true, {});
+          EXPECT_EQ(result, expected)
+            << "plies " << plies << ", table " << table << ", ordering "
+            << ordering << ", threads " << threads << ", parallel "
+            << static_cast<int>(parallel);
+        }
+  }
+}
+
+TEST_F(PlayerTest, NoTimeLeft) {
+  // depth 1 is always completed so a move is returned even if there's no time
+  // (and no deeper searches are started)
+  const ComputerPlayer player(
+    C::Black, Board::Size, false, score,
+    {.timeControl = {ComputerPlayer::TimeControl::Type::PerGame,
+                     std::chrono::milliseconds(0)}});
+  EXPECT_CALL(*score, scoreBoard(b1, _, _, _)).WillOnce(Return(10));
+  EXPECT_CALL(*score, scoreBoard(b2, _, _, _)).WillOnce(Return(7));
+  EXPECT_CALL(*score, scoreBoard(b3, _, _, _)).WillOnce(Return(12));
+  EXPECT_CALL(*score, scoreBoard(b4, _, _, _)).WillOnce(Return(-5));
+  player.move(board, true, {});
+  EXPECT_EQ(board, b3);
+  EXPECT_CALL(*score, toString()).WillOnce(Return("mock"));
+  EXPECT_EQ(player.toString(),
+            "Black (mock) with time=0ms per game (score called 4, nodes 0)");
+}
+
+TEST_F(PlayerTest, TimeLimitPerMove) {
+  const auto time = std::chrono::milliseconds(20);
+  const ComputerPlayer player(
+    C::Black, Board::Size, false, std::make_shared<FullScore>(),
+    {.timeControl = {ComputerPlayer::TimeControl::Type::PerMove, time}});
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(player.move(board, true, {}));
+  // allow plenty of extra time to avoid failing on a slow or busy machine
+  EXPECT_LT(std::chrono::steady_clock::now() - start, time * 10);
+  EXPECT_EQ(board.blackCount(), 4);
+}
+
+TEST_F(PlayerTest, LazySmp) {
+  using Parallel = ComputerPlayer::Parallel;
+  const auto s = std::make_shared<FullScore>();
+  const ComputerPlayer player(C::Black, 5, false, s,
+                              {.threads = 4, .parallel = Parallel::LazySmp});
+  EXPECT_EQ(player.toString(),
+            "Black (FullScore) with search=5 threads=4 (lazy smp) (score "
+            "called 0, nodes 0)");
+  EXPECT_TRUE(player.move(board, true, {}));
+  EXPECT_EQ(board.blackCount(), 4);
+  // helper threads stop when the main search is done (or time runs out)
+  const auto time = std::chrono::milliseconds(20);
+  const ComputerPlayer timed(
+    C::White, Board::Size, false, s,
+    {.timeControl = {ComputerPlayer::TimeControl::Type::PerMove, time},
+     .threads = 4,
+     .parallel = Parallel::LazySmp});
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(timed.move(board, true, {}));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, time * 10);
+  EXPECT_EQ(board.whiteCount(), 3);
+}
+
+TEST_F(PlayerTest, Endgame) {
+  std::mt19937 gen(1);
+  for (auto i = 0; i < 5; ++i) {
+    // play random moves until there are 10 empty cells
+    auto c = C::Black;
+    const auto b = randomBoard(gen, 10, c);
+    if (!b.hasValidMoves(c)) c = Board::opColor(c);
+    if (!b.hasValidMoves(c)) continue;
+    // the move played should have the best exact result (the mock score is
+    // never called once the solver is used)
+    const auto result = [](const Board& x, C turn) {
+      return Endgame().solve(x, turn);
+    };
+    int best = -Endgame::Inf;
+    for (const auto& child : b.children(c))
+      best = std::max(best, -result(child.board, Board::opColor(c)));
+    const ComputerPlayer player(
+      c, 2, true, score, {.endgame = {10, Endgame::Mode::Exact}});
+    auto played = b;
+    player.move(played, true, {});
+    EXPECT_EQ(-result(played, Board::opColor(c)), best);
+    EXPECT_EQ(player.totalScoreCalls(), 0);
+    // 'WinLossDraw' only has to play a move with the same win, loss or draw
+    const ComputerPlayer wld(
+      c, 2, true, score, {.endgame = {10, Endgame::Mode::WinLossDraw}});
+    played = b;
+    wld.move(played, true, {});
+    const auto sign = [](int x) { return x > 0 ? 1 : x < 0 ? -1 : 0; };
+    EXPECT_EQ(sign(-result(played, Board::opColor(c))), sign(best));
+  }
+  EXPECT_CALL(*score, toString()).WillOnce(Return("mock"));
+  const ComputerPlayer player(
+    C::Black, 3, false, score, {.endgame = {20, Endgame::Mode::WinLossDraw}});
+  EXPECT_EQ(player.toString(), "Black (mock) with search=3 endgame=20 (wld) "
+                               "(score called 0, nodes 0)");
+}
+
+TEST_F(PlayerTest, Ponder) {
+  // without a table all replies are searched while pondering so the next move
+  // is always a 'ponder hit' (and gets the same result as without pondering)
+  const auto s = std::make_shared<FullScore>();
+  const ComputerPlayer player(C::Black, 4, false, s,
+                              {.tableMegabytes = 0, .ponder = true});
+  const ComputerPlayer other(C::Black, 4, false, s, {.tableMegabytes = 0});
+  const ComputerPlayer white(C::White, 1, false, s);
+  EXPECT_EQ(player.toString(), "Black (FullScore) with search=4 ponder (score "
+                               "called 0, nodes 0)");
+  auto otherBoard = board;
+  for (auto i = 0; i < 3; ++i) {
+    player.move(board, true, {});
+    other.move(otherBoard, true, {});
+    EXPECT_EQ(board, otherBoard);
+    white.move(board, true, {});
+    player.opponentMoved();
+    otherBoard = board;
+  }
+  EXPECT_EQ(player.ponderHits(), 2);
+  // 'analyze' stops pondering before searching
+  player.move(board, true, {});
+  white.move(board, true, {});
+  EXPECT_EQ(player.analyze(board), other.analyze(board));
+  // the last search is still pondering when 'player' is destroyed
+  player.move(board, true, {});
+}
+
+TEST_F(PlayerTest, TimedPonder) {
+  // pondering after a timed search (that may have run out of time) searches as
+  // much as pondering after a fixed depth search
+  const auto time = std::chrono::milliseconds(30);
+  const ComputerPlayer player(
+    C::Black, Board::Size, false, std::make_shared<FullScore>(),
+    {.timeControl = {ComputerPlayer::TimeControl::Type::PerMove, time},
+     .ponder = true});
+  const ComputerPlayer white(C::White, 1, false, std::make_shared<FullScore>());
+  for (auto i = 0; i < 3; ++i) {
+    player.move(board, true, {});
+    const auto searched = player.totalNodes();
+    std::this_thread::sleep_for(time * 4);
+    player.opponentMoved();
+    // allow for a slow or busy machine (pondering for 4 times as long as the
+    // search usually finds more than 4 times as many nodes)
+    EXPECT_GT(player.totalNodes() - searched, player.lastMoveStats().nodes)
+      << "move " << i;
+    white.move(board, true, {});
+  }
+}
+
+TEST_F(PlayerTest, Stats) {
+  using Parallel = ComputerPlayer::Parallel;
+  const auto s = std::make_shared<FullScore>();
+  for (auto [threads, parallel] :
+       {std::pair<size_t, Parallel>{1, Parallel::RootSplit},
+        {4, Parallel::RootSplit},
+        {4, Parallel::Ybwc}}) {
+    const ComputerPlayer player(C::Black, 5, false, s,
+                                {.threads = threads, .parallel = parallel});
+    auto b = board;
+    player.move(b, true, {});
+    const auto stats = player.lastMoveStats();
+    EXPECT_GT(stats.nodes, 0);
+    EXPECT_GT(stats.leaves, 0);
+    EXPECT_GT(stats.cutoffs[0], 0);
+    EXPECT_GT(stats.tableProbes, stats.tableHits);
+    EXPECT_GT(stats.tableStores, 0);
+    EXPECT_EQ(stats.depth, 5);
+    EXPECT_GT(stats.depthTimes[4].count(), 0);
+    EXPECT_GE(stats.time, stats.depthTimes[4]);
+    EXPECT_GT(stats.branchingFactor(), 1);
+    // counts from all threads are merged into the stats for the move
+    EXPECT_EQ(player.totalNodes(), stats.nodes);
+    EXPECT_EQ(player.totalScoreCalls(), stats.leaves);
+    const auto white = b;
+    player.move(b = white, true, {});
+    EXPECT_EQ(player.totalStats().nodes,
+              stats.nodes + player.lastMoveStats().nodes);
+  }
+  // iterative deepening records the time of each completed depth
+  const auto time = std::chrono::milliseconds(20);
+  const ComputerPlayer timed(
+    C::Black, Board::Size, false, s,
+    {.timeControl = {ComputerPlayer::TimeControl::Type::PerMove, time}});
+  timed.move(board, true, {});
+  const auto stats = timed.lastMoveStats();
+  EXPECT_GT(stats.depth, 1);
+  for (size_t i = 0; i < stats.depth; ++i)
+    EXPECT_GT(stats.depthTimes[i].count(), 0);
+}
+
+TEST_F(PlayerTest, OpeningBook) {
+  // put 'e6' (the move that gives 'b3') in the book for the initial board
+  const std::string file = "PlayerTest.book";
+  const auto [canonical, sym] = board.canonical();
+  ASSERT_TRUE(OpeningBook::write(
+    file, {{canonical.hash(C::Black), 0,
+            static_cast<uint8_t>(Board::transformPos(44 /* e6 */, sym)), 1}}));
+  const auto book = std::make_shared<const OpeningBook>(file);
+  std::remove(file.c_str()); // the book is still mapped
+  const ComputerPlayer player(C::Black, 2, false, score, {.book = book});
+  // the book move is played without searching (so 'score' isn't called)
+  player.move(board, true, {});
+  EXPECT_EQ(board, b3);
+  EXPECT_EQ(player.bookMoves(), 1);
+  EXPECT_EQ(player.totalScoreCalls(), 0);
+  // 'analyze' doesn't use the book
+  const ComputerPlayer white(C::White, 1, false, std::make_shared<FullScore>());
+  const auto [move, value] = white.analyze(board);
+  auto expected = board;
+  white.move(expected, true, {});
+  auto result = board;
+  result.set(move, C::White);
+  EXPECT_EQ(result, expected);
+  EXPECT_EQ(value, FullScore().score(result, C::White));
+}
+
+TEST_F(PlayerTest, SearchCache) {
+  const std::string file = "PlayerTest.cache";
+  const auto s = std::make_shared<FullScore>();
+  const auto cache =
+    std::make_shared<SearchCache>(file, SearchCache::config(*s, 4));
+  const auto player = [&](size_t depth) {
+    return std::make_unique<ComputerPlayer>(
+      C::Black, depth, false, s, ComputerPlayer::Options{.cache = cache});
+  };
+  // the first search adds its result and the second one reuses it
+  auto b = board;
+  const auto first = player(4);
+  first->move(b, true, {});
+  EXPECT_EQ(first->cacheHits(), 0);
+  EXPECT_EQ(cache->size(), 1);
+  auto cached = board;
+  const auto second = player(4);
+  second->move(cached, true, {});
+  EXPECT_EQ(cached, b);
+  EXPECT_EQ(second->cacheHits(), 1);
+  EXPECT_EQ(second->totalNodes(), 0);
+  // a player with a different search depth doesn't use the cache
+  const auto other = player(3);
+  auto x = board;
+  other->move(x, true, {});
+  EXPECT_EQ(other->cacheHits(), 0);
+  EXPECT_EQ(cache->size(), 1);
+  // results are still there after flushing and loading the file again
+  EXPECT_TRUE(cache->flush());
+  const auto loaded =
+    std::make_shared<SearchCache>(file, SearchCache::config(*s, 4));
+  std::remove(file.c_str());
+  EXPECT_EQ(loaded->size(), 1);
+  EXPECT_TRUE(loaded->find(board.hash(C::Black)));
+}
+
+TEST_F(PlayerTest, ProbCut) {
+  const auto s = std::make_shared<FullScore>();
+  const auto player = [&](C c, size_t selectivity) {
+    return std::make_unique<ComputerPlayer>(
+      c, 6, false, s, ComputerPlayer::Options{.selectivity = selectivity});
+  };
+  EXPECT_EQ(player(C::Black, 2)->toString(),
+            "Black (FullScore) with search=6 selectivity=2 (score called 0, "
+            "nodes 0)");
+  // search the same positions with and without selectivity (pruning costs
+  // more than it saves for some positions, but it saves overall)
+  std::mt19937 gen(1);
+  std::vector<std::pair<Board, C>> positions;
+  for (auto [b, c] = std::pair(board, C::Black); positions.size() < 8;) {
+    ASSERT_TRUE(randomMove(b, c, gen));
+    if (b.hasValidMoves(c)) positions.emplace_back(b, c);
+  }
+  std::array<long long, 2> nodes{}, probCuts{};
+  for (size_t i = 0; i < nodes.size(); ++i)
+    for (auto& [b, c] : positions) {
+      const auto p = player(c, i * ProbCut::MaxSelectivity);
+      p->analyze(b);
+      nodes[i] += p->totalNodes() + p->totalScoreCalls();
+      probCuts[i] += p->totalStats().probCuts;
+    }
+  EXPECT_EQ(probCuts[0], 0);
+  EXPECT_GT(probCuts[1], 0);
+  EXPECT_LT(nodes[1], nodes[0]);
+}
+
+TEST_F(PlayerTest, StaticScoreSearch) {
+  // a 'FullScore' player searches without virtual calls to score positions
+  // whereas a mock (that returns 'FullScore' values) uses the virtual calls -
+  // both should search the same positions and make the same moves
+  const auto full = std::make_shared<FullScore>();
+  EXPECT_CALL(*score, scoreBoard(_, _, _, _))
+    .WillRepeatedly([&full](const Board& b, Set myVals, Set, bool) {
+      return full->score(b, myVals == b.black() ? C::Black : C::White);
+    });
+  using Parallel = ComputerPlayer::Parallel;
+  for (auto [threads, parallel] :
+       {std::pair<size_t, Parallel>{1, Parallel::RootSplit},
+        {4, Parallel::Ybwc}}) {
+    const ComputerPlayer fullPlayer(
+      C::Black, 5, false, full, {.threads = threads, .parallel = parallel}),
+      mockPlayer(C::Black, 5, false, score,
+                 {.threads = threads, .parallel = parallel});
+    auto fullBoard = board, mockBoard = board;
+    fullPlayer.move(fullBoard, true, {});
+    mockPlayer.move(mockBoard, true, {});
+    EXPECT_EQ(fullBoard, mockBoard);
+    if (threads == 1) {
+      EXPECT_EQ(fullPlayer.totalNodes(), mockPlayer.totalNodes());
+      EXPECT_EQ(fullPlayer.totalScoreCalls(), mockPlayer.totalScoreCalls());
+    }
+  }
+}
+
 } // namespace othello
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <othello/ProbCut.h>
+
+#include <cmath>
+
+namespace othello {
+
+TEST(ProbCutTest, ShallowDepth) {
+  EXPECT_EQ(ProbCut::shallowDepth(ProbCut::MinDepth - 1), 0);
+  EXPECT_EQ(ProbCut::shallowDepth(3), 1);
+  EXPECT_EQ(ProbCut::shallowDepth(4), 2);
+  EXPECT_EQ(ProbCut::shallowDepth(5), 3);
+  EXPECT_EQ(ProbCut::shallowDepth(7), 3);
+  EXPECT_EQ(ProbCut::shallowDepth(10), 6);
+  EXPECT_EQ(ProbCut::shallowDepth(ProbCut::MaxDepth + 1), 0);
+}
+
+TEST(ProbCutTest, Stage) {
+  Board board;
+  EXPECT_EQ(ProbCut::stage(board), 0);
+  // play moves until the last stage
+  auto c = Board::Color::Black;
+  for (size_t moves = 0; moves < ProbCut::StageMoves * 3; ++moves) {
+    if (moves % ProbCut::StageMoves == 0)
+      EXPECT_EQ(ProbCut::stage(board), moves / ProbCut::StageMoves);
+    if (!board.hasValidMoves(c)) c = Board::opColor(c);
+    ASSERT_TRUE(board.hasValidMoves(c));
+    board.set(board.validMoves(c)[0], c);
+    c = Board::opColor(c);
+  }
+  EXPECT_EQ(ProbCut::stage(board), ProbCut::Stages - 1);
+}
+
+TEST(ProbCutTest, Fit) {
+  // points on the line 'y = 2x + 3' give no error
+  const auto exact =
+    ProbCut::fit(2, 5, 1, {{0, 3}, {1, 5}, {2, 7}, {-4, -5}});
+  EXPECT_EQ(exact.stage, 2);
+  EXPECT_EQ(exact.depth, 5);
+  EXPECT_EQ(exact.shallow, 1);
+  EXPECT_DOUBLE_EQ(exact.a, 2);
+  EXPECT_DOUBLE_EQ(exact.b, 3);
+  EXPECT_NEAR(exact.sigma, 0, 1e-9);
+  // errors of +1 and -1 around 'y = x'
+  const auto noisy = ProbCut::fit(0, 4, 2, {{0, 1}, {0, -1}, {2, 3}, {2, 1}});
+  EXPECT_DOUBLE_EQ(noisy.a, 1);
+  EXPECT_DOUBLE_EQ(noisy.b, 0);
+  EXPECT_DOUBLE_EQ(noisy.sigma, std::sqrt(2.0));
+  // not enough samples
+  const auto few = ProbCut::fit(0, 3, 1, {{1, 2}, {3, 4}});
+  EXPECT_EQ(few.a, 1);
+  EXPECT_EQ(few.b, 0);
+}
+
+TEST(ProbCutTest, Selectivity) {
+  const ProbCut off;
+  EXPECT_FALSE(off.enabled());
+  EXPECT_EQ(off.threshold(), 0);
+  // selectivity 0 doesn't prune (even if there are checks)
+  EXPECT_FALSE(ProbCut(FullScore(), 0).enabled());
+  EXPECT_TRUE(ProbCut(FullScore(), 0).checks(0, 5).empty());
+  const ProbCut full(FullScore(), 2);
+  EXPECT_TRUE(full.enabled());
+  EXPECT_EQ(full.threshold(), ProbCut::Thresholds[2]);
+  // higher levels use lower thresholds (so more positions are pruned)
+  for (size_t i = 2; i <= ProbCut::MaxSelectivity; ++i)
+    EXPECT_LT(ProbCut::Thresholds[i], ProbCut::Thresholds[i - 1]);
+  EXPECT_EQ(ProbCut(WeightedScore(), 9).selectivity(), ProbCut::MaxSelectivity);
+}
+
+TEST(ProbCutTest, Calibrations) {
+  // every 'Score' type has a check for each depth in the first stage (later
+  // stages can be missing if there weren't enough samples)
+  for (const auto& p : {ProbCut(FullScore(), 1), ProbCut(WeightedScore(), 1)})
+    for (size_t stage = 0; stage < ProbCut::Stages; ++stage)
+      for (size_t depth = ProbCut::MinDepth; depth <= ProbCut::MaxDepth;
+           ++depth) {
+        const auto checks = p.checks(stage, depth);
+        if (stage) {
+          ASSERT_LE(checks.size(), 1);
+          if (checks.empty()) continue;
+        } else
+          ASSERT_EQ(checks.size(), 1);
+        EXPECT_EQ(checks[0].stage, stage);
+        EXPECT_EQ(checks[0].depth, depth);
+        EXPECT_EQ(checks[0].shallow, ProbCut::shallowDepth(depth));
+        EXPECT_GT(checks[0].a, 0);
+        EXPECT_GT(checks[0].sigma, 0);
+      }
+}
+
+TEST(ProbCutTest, Checks) {
+  const ProbCut p({{1, 6, 2, 1, 0, 5},
+                   {0, 4, 2, 1, 0, 3},
+                   {1, 6, 4, 1, 0, 4},
+                   {0, 6, 2, 1, 0, 2}},
+                  1);
+  EXPECT_TRUE(p.enabled());
+  EXPECT_TRUE(p.checks(0, 5).empty());
+  EXPECT_TRUE(p.checks(1, 4).empty());
+  ASSERT_EQ(p.checks(0, 4).size(), 1);
+  EXPECT_EQ(p.checks(0, 4)[0].sigma, 3);
+  ASSERT_EQ(p.checks(0, 6).size(), 1);
+  EXPECT_EQ(p.checks(0, 6)[0].sigma, 2);
+  // checks for the same stage and depth stay in the given order
+  ASSERT_EQ(p.checks(1, 6).size(), 2);
+  EXPECT_EQ(p.checks(1, 6)[0].shallow, 2);
+  EXPECT_EQ(p.checks(1, 6)[1].shallow, 4);
+  // depths outside 'MinDepth' to 'MaxDepth' are never checked
+  EXPECT_TRUE(ProbCut({{0, 2, 1, 1, 0, 1}}, 1).checks(0, 2).empty());
+}
+
+} // namespace othello
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <othello/RandomMoves.h>
 #include <othello/Score.h>
 
 namespace othello {
@@ -14,15 +15,23 @@ protected:
   }
   void set(const std::string& initialLayout) { board = Board(initialLayout); }
   void check(int s) {
-    for (auto c : Board::Colors)
+    for (auto c : Board::Colors) {
       ASSERT_EQ(score->score(board, c), c == Board::Color::Black ? s : -s)
         << "FullScore for: " << c;
+      ASSERT_EQ(Score::staticScore(FullScore(), board, c),
+                score->score(board, c))
+        << "static FullScore for: " << c;
+    }
   }
   void checkWeighted(int s) {
-    for (auto c : Board::Colors)
+    for (auto c : Board::Colors) {
       ASSERT_EQ(weightedScore->score(board, c),
                 c == Board::Color::Black ? s : -s)
         << "WeightedScore for: " << c;
+      ASSERT_EQ(Score::staticScore(WeightedScore(), board, c),
+                weightedScore->score(board, c))
+        << "static WeightedScore for: " << c;
+    }
   }
   Board board;
   std::unique_ptr<Score> score = std::make_unique<FullScore>();
@@ -512,4 +521,20 @@ oo*****.");
   checkWeighted(black - white);
 }
 
+TEST_F(ScoreTest, StaticScore) {
+  // 'staticScore' matches 'score' for every position of some random games
+  // (including the final positions)
+  std::mt19937 gen(1);
+  for (auto game = 0; game < 20; ++game) {
+    board = Board();
+    for (auto c = Board::Color::Black; randomMove(board, c, gen);)
+      for (auto i : Board::Colors) {
+        ASSERT_EQ(Score::staticScore(FullScore(), board, i),
+                  score->score(board, i));
+        ASSERT_EQ(Score::staticScore(WeightedScore(), board, i),
+                  weightedScore->score(board, i));
+      }
+  }
+}
+
 } // namespace othello
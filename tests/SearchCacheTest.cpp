@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <othello/SearchCache.h>
+
+#include <cstdio>
+
+namespace othello {
+
+using Entry = SearchCache::Entry;
+
+class SearchCacheTest : public ::testing::Test {
+protected:
+  void TearDown() override { std::remove(file.c_str()); }
+
+  const std::string file = "SearchCacheTest.cache";
+  const uint64_t config = SearchCache::config(FullScore(), 5);
+};
+
+TEST_F(SearchCacheTest, Config) {
+  EXPECT_EQ(config, SearchCache::config(FullScore(), 5));
+  EXPECT_NE(config, SearchCache::config(FullScore(), 6));
+  EXPECT_NE(config, SearchCache::config(WeightedScore(), 5));
+  EXPECT_EQ(config, SearchCache::config(FullScore(), 5, 0));
+  EXPECT_NE(config, SearchCache::config(FullScore(), 5, 1));
+}
+
+TEST_F(SearchCacheTest, AddAndFind) {
+  SearchCache cache(file, config);
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_FALSE(cache.find(7));
+  cache.add({7, 0b110, -3, 5, 0});
+  const auto entry = cache.find(7);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->moves, 0b110);
+  EXPECT_EQ(entry->score, -3);
+  EXPECT_EQ(entry->depth, 5);
+  // adding the same hash replaces the entry
+  cache.add({7, 0b1, 4, 5, 0});
+  EXPECT_EQ(cache.find(7)->score, 4);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST_F(SearchCacheTest, FlushAndLoad) {
+  {
+    SearchCache cache(file, config);
+    for (Board::Set i : {30, 10, 20}) cache.add({i, i, 1, 5, 0});
+    EXPECT_TRUE(cache.flush());
+  }
+  SearchCache cache(file, config);
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.added(), 0);
+  for (Board::Set i : {10, 20, 30}) {
+    const auto entry = cache.find(i);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->moves, i);
+  }
+  EXPECT_FALSE(cache.find(15));
+  // new entries replace loaded ones and flushing again keeps everything (the
+  // file is replaced while it's still mapped)
+  cache.add({20, 5, 2, 6, 0});
+  cache.add({40, 40, 3, 5, 0});
+  EXPECT_EQ(cache.size(), 4);
+  EXPECT_TRUE(cache.flush());
+  EXPECT_EQ(cache.find(10)->moves, 10);
+  const SearchCache reloaded(file, config);
+  EXPECT_EQ(reloaded.size(), 4);
+  EXPECT_EQ(reloaded.find(20)->depth, 6);
+  EXPECT_EQ(reloaded.find(40)->score, 3);
+}
+
+TEST_F(SearchCacheTest, DifferentConfig) {
+  {
+    SearchCache cache(file, config);
+    cache.add({1, 1, 1, 5, 0});
+    EXPECT_TRUE(cache.flush());
+  }
+  // a file written for a different config isn't used
+  const SearchCache other(file, SearchCache::config(WeightedScore(), 5));
+  EXPECT_EQ(other.size(), 0);
+  EXPECT_FALSE(other.find(1));
+}
+
+} // namespace othello
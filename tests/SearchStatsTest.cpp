@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <othello/SearchStats.h>
+
+#include <sstream>
+
+namespace othello {
+
+using namespace std::chrono_literals;
+
+TEST(SearchStatsTest, Cutoffs) {
+  SearchStats s;
+  EXPECT_EQ(s.firstMoveCutoffs(), 0);
+  s.cutoff(0);
+  s.cutoff(0);
+  s.cutoff(0);
+  s.cutoff(20); // counted in the last entry
+  EXPECT_EQ(s.cutoffs[0], 3);
+  EXPECT_EQ(s.cutoffs[SearchStats::CutoffIndexes - 1], 1);
+  EXPECT_DOUBLE_EQ(s.firstMoveCutoffs(), 0.75);
+}
+
+TEST(SearchStatsTest, Rates) {
+  SearchStats s;
+  EXPECT_EQ(s.nodesPerSecond(), 0);
+  EXPECT_EQ(s.branchingFactor(), 0);
+  s.nodes = 200;
+  s.leaves = 800;
+  s.depth = 3;
+  s.time = 2ms;
+  EXPECT_DOUBLE_EQ(s.nodesPerSecond(), 500'000);
+  EXPECT_NEAR(s.branchingFactor(), 10, 0.0001);
+}
+
+TEST(SearchStatsTest, Merge) {
+  SearchStats x, y;
+  x.nodes = 5;
+  x.leaves = 7;
+  x.cutoff(1);
+  x.tableProbes = 3;
+  x.depth = 4;
+  x.depthTimes[0] = 1ms;
+  x.time = 3ms;
+  y.nodes = 10;
+  y.tableHits = 2;
+  y.tableStores = 1;
+  y.probCuts = 3;
+  y.cutoff(1);
+  y.depth = 2;
+  y.depthTimes[0] = 2ms;
+  y.time = 1ms;
+  x += y;
+  EXPECT_EQ(x.nodes, 15);
+  EXPECT_EQ(x.leaves, 7);
+  EXPECT_EQ(x.cutoffs[1], 2);
+  EXPECT_EQ(x.tableProbes, 3);
+  EXPECT_EQ(x.tableHits, 2);
+  EXPECT_EQ(x.tableStores, 1);
+  EXPECT_EQ(x.probCuts, 3);
+  EXPECT_EQ(x.depth, 4);
+  EXPECT_EQ(x.depthTimes[0], 3ms);
+  EXPECT_EQ(x.time, 4ms);
+}
+
+TEST(SearchStatsTest, Print) {
+  SearchStats s;
+  s.nodes = 20;
+  s.leaves = 80;
+  s.depth = 2;
+  s.cutoff(0);
+  s.tableProbes = 10;
+  s.tableHits = 4;
+  s.tableStores = 6;
+  s.depthTimes[0] = 1ms;
+  s.depthTimes[1] = 4ms;
+  s.time = 5ms;
+  std::stringstream ss;
+  ss << s << ' ' << 1.5;
+  EXPECT_EQ(ss.str(), "nodes 20, leaves 80, 20000 nodes/sec, depth 2, "
+                      "branching factor 10.00\n"
+                      "  cutoffs by move: 1 0 0 0 0 0 0 0 (first move 100.0%)\n"
+                      "  table probes 10, hits 4, stores 6\n"
+                      "  time 0.005000 secs, by depth: 0.001000 0.004000 1.5");
+  // 'probCuts' is only printed if there were any
+  s.probCuts = 2;
+  ss.str("");
+  ss << s;
+  EXPECT_NE(ss.str().find("stores 6, probcuts 2\n"), std::string::npos);
+}
+
+} // namespace othello
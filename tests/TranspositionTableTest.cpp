@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <othello/Score.h>
+#include <othello/TranspositionTable.h>
+
+#include <thread>
+
+namespace othello {
+
+using Bound = TranspositionTable::Bound;
+
+class TranspositionTableTest : public ::testing::Test {
+protected:
+  // return a hash that maps to the same bucket as 'hash'
+  auto sameBucket(Board::Set hash, int i) const {
+    return hash + static_cast<Board::Set>(i) * table.size() /
+                    TranspositionTable::BucketSize;
+  }
+  TranspositionTable table{1};
+};
+
+TEST_F(TranspositionTableTest, Size) {
+  // 1 MB with 64 byte buckets of 4 entries
+  EXPECT_EQ(table.megabytes(), 1);
+  EXPECT_EQ(table.size(), 1024 * 1024 / 64 * 4);
+  // number of buckets is rounded down to a power of 2
+  EXPECT_EQ(TranspositionTable(3).megabytes(), 2);
+  // a 0 size table never stores anything
+  TranspositionTable empty(0);
+  EXPECT_EQ(empty.size(), 0);
+  empty.store(1, 5, Bound::Exact, 10, 19);
+  EXPECT_FALSE(empty.probe(1));
+}
+
+TEST_F(TranspositionTableTest, StoreAndProbe) {
+  const Board board;
+  const auto hash = board.hash(Board::Color::Black);
+  EXPECT_FALSE(table.probe(hash));
+  table.store(hash, 5, Bound::Lower, -Score::Win, 19);
+  const auto entry = table.probe(hash);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->score, -Score::Win);
+  EXPECT_EQ(entry->depth, 5);
+  EXPECT_EQ(entry->bound, Bound::Lower);
+  EXPECT_EQ(entry->move, 19);
+  // different side to move is a different position
+  EXPECT_FALSE(table.probe(board.hash(Board::Color::White)));
+  // storing the same position again replaces the entry (even if it's lower
+  // depth) and the default move is 'NoMove'
+  table.store(hash, 2, Bound::Exact, 7);
+  EXPECT_EQ(table.probe(hash)->score, 7);
+  EXPECT_EQ(table.probe(hash)->move, TranspositionTable::NoMove);
+  // 0 depth entries aren't stored
+  table.store(hash + 1, 0, Bound::Exact, 7);
+  EXPECT_FALSE(table.probe(hash + 1));
+  table.clear();
+  EXPECT_FALSE(table.probe(hash));
+}
+
+TEST_F(TranspositionTableTest, Replacement) {
+  const Board::Set hash = 12345;
+  // fill a bucket with depths 4, 3, 2 and 5
+  const std::array<size_t, 4> depths = {4, 3, 2, 5};
+  for (auto i = 0; i < 4; ++i)
+    table.store(sameBucket(hash, i), depths[static_cast<size_t>(i)],
+                Bound::Exact, 0);
+  for (auto i = 0; i < 4; ++i) EXPECT_TRUE(table.probe(sameBucket(hash, i)));
+  // a new entry always gets stored and replaces the lowest depth entry
+  table.store(sameBucket(hash, 4), 1, Bound::Exact, 0);
+  EXPECT_TRUE(table.probe(sameBucket(hash, 4)));
+  EXPECT_FALSE(table.probe(sameBucket(hash, 2)));
+  // entries from previous searches are replaced first (lowest depth first)
+  // so the new depth 1 entry isn't replaced by the following store
+  table.newSearch();
+  table.store(sameBucket(hash, 0), 4, Bound::Exact, 0); // refresh depth 4
+  table.store(sameBucket(hash, 5), 1, Bound::Exact, 0); // replaces depth 1
+  table.store(sameBucket(hash, 6), 1, Bound::Exact, 0); // replaces depth 3
+  for (auto i : {0, 3, 5, 6}) EXPECT_TRUE(table.probe(sameBucket(hash, i)));
+  for (auto i : {1, 4}) EXPECT_FALSE(table.probe(sameBucket(hash, i)));
+}
+
+TEST_F(TranspositionTableTest, ConcurrentAccess) {
+  // threads write entries where all fields are derived from the hash so any
+  // entry returned by 'probe' can be checked (a torn write must be a miss)
+  const auto score = [](Board::Set hash) {
+    return static_cast<int>(hash % 2'000'001) - Score::Win;
+  };
+  const auto depth = [](Board::Set hash) { return hash % 60 + 1; };
+  std::vector<std::thread> threads;
+  std::atomic<size_t> hits = 0, errors = 0;
+  for (Board::Set t = 0; t < 4; ++t)
+    threads.emplace_back([&, t] {
+      for (Board::Set i = 0; i < 100'000; ++i) {
+        // use a small range of buckets so threads collide
+        const auto hash = (i % 64) * 0x9e3779b97f4a7c15ULL + i % 512 + t;
+        if (const auto entry = table.probe(hash)) {
+          ++hits;
+          if (entry->score != score(hash) || entry->depth != depth(hash) ||
+              entry->move != hash % Board::Size)
+            ++errors;
+        }
+        table.store(hash, depth(hash), Bound::Exact, score(hash),
+                    hash % Board::Size);
+      }
+    });
+  for (auto& i : threads) i.join();
+  EXPECT_GT(hits, 0);
+  EXPECT_EQ(errors, 0);
+}
+
+} // namespace othello
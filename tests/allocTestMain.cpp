@@ -0,0 +1,96 @@
+#include "Allocations.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// replace every form of global 'operator new' and 'operator delete' so that
+// allocations can be counted. All forms use 'malloc' or 'aligned_alloc' and
+// 'free' so memory from any 'new' can be released by any 'delete'. These are
+// kept in their own file (away from code that calls 'new') so the compiler
+// can't inline them and then see 'free' called on memory from 'new'.
+
+namespace {
+
+std::atomic<size_t> count = 0;
+
+constexpr auto DefaultAlign =
+    std::align_val_t{__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+
+void* allocate(size_t size,
+               std::align_val_t alignment = DefaultAlign) noexcept {
+  ++count;
+  const auto align = static_cast<size_t>(alignment);
+  if (!size) size = 1;
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return std::malloc(size);
+  // 'aligned_alloc' requires 'size' to be a multiple of 'align'
+  return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+void* allocateOrThrow(size_t size, std::align_val_t alignment = DefaultAlign) {
+  if (auto* p = allocate(size, alignment)) return p;
+  throw std::bad_alloc();
+}
+
+} // namespace
+
+namespace othello {
+
+size_t allocations() { return count; }
+
+} // namespace othello
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+void* operator new(size_t size, std::align_val_t align) {
+  return allocateOrThrow(size, align);
+}
+void* operator new[](size_t size, std::align_val_t align) {
+  return allocateOrThrow(size, align);
+}
+void* operator new(size_t size, std::align_val_t align,
+                   const std::nothrow_t&) noexcept {
+  return allocate(size, align);
+}
+void* operator new[](size_t size, std::align_val_t align,
+                     const std::nothrow_t&) noexcept {
+  return allocate(size, align);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}